@@ -0,0 +1,228 @@
+#include "actor_message_parser.h"
+#include <nlohmann/json.hpp>
+#include <cstring>
+
+using json = nlohmann::json;
+
+namespace {
+
+constexpr uint8_t HAS_ID = 1;
+constexpr uint8_t HAS_X = 2;
+constexpr uint8_t HAS_Y = 4;
+constexpr uint8_t HAS_Z = 8;
+constexpr uint8_t HAS_ALL = HAS_ID | HAS_X | HAS_Y | HAS_Z;
+
+} // namespace
+
+bool ActorIdToNodeId(const char* id, size_t size, uint32_t& nodeId)
+{
+    if (size == 3 && std::memcmp(id, "gcs", 3) == 0)
+    {
+        nodeId = 0;
+        return true;
+    }
+    // "uav" followed by 1 to 9 digits
+    if (size < 4 || size > 12 || std::memcmp(id, "uav", 3) != 0)
+    {
+        return false;
+    }
+    uint64_t value = 0;
+    for (size_t i = 3; i < size; i++)
+    {
+        if (id[i] < '0' || id[i] > '9')
+        {
+            return false;
+        }
+        value = value * 10 + (id[i] - '0');
+    }
+    if (value > UINT32_MAX)
+    {
+        return false;
+    }
+    nodeId = static_cast<uint32_t>(value);
+    return true;
+}
+
+ActorMessageParser::ActorMessageParser()
+    : m_depth(0),
+      m_actorsDepth(0),
+      m_actorsKey(false),
+      m_sawActors(false),
+      m_event(false),
+      m_field(FIELD_OTHER),
+      m_fields(0),
+      m_skipped(0)
+{
+    m_actors.reserve(256);
+}
+
+ActorMessageParser::Result ActorMessageParser::Parse(const char* data, size_t size)
+{
+    m_actors.clear(); // Keeps the capacity
+    m_depth = 0;
+    m_actorsDepth = 0;
+    m_actorsKey = false;
+    m_sawActors = false;
+    m_event = false;
+    m_field = FIELD_OTHER;
+    m_skipped = 0;
+    m_error.clear();
+
+    if (!json::sax_parse(data, data + size, this))
+    {
+        if (m_event)
+        {
+            return OTHER;
+        }
+        if (m_error.empty())
+        {
+            m_error = "Parse stopped";
+        }
+        return ERROR;
+    }
+    return m_sawActors ? ACTORS : OTHER;
+}
+
+bool ActorMessageParser::Number(double value)
+{
+    if (InActor())
+    {
+        switch (m_field)
+        {
+        case FIELD_X:
+            m_actor.position.x = value;
+            m_fields |= HAS_X;
+            break;
+        case FIELD_Y:
+            m_actor.position.y = value;
+            m_fields |= HAS_Y;
+            break;
+        case FIELD_Z:
+            m_actor.position.z = value;
+            m_fields |= HAS_Z;
+            break;
+        default:
+            break;
+        }
+    }
+    m_actorsKey = false;
+    return true;
+}
+
+bool ActorMessageParser::null()
+{
+    m_actorsKey = false;
+    return true;
+}
+
+bool ActorMessageParser::boolean(bool value)
+{
+    m_actorsKey = false;
+    return true;
+}
+
+bool ActorMessageParser::number_integer(int64_t value)
+{
+    return Number(static_cast<double>(value));
+}
+
+bool ActorMessageParser::number_unsigned(uint64_t value)
+{
+    return Number(static_cast<double>(value));
+}
+
+bool ActorMessageParser::number_float(double value, const std::string& text)
+{
+    return Number(value);
+}
+
+bool ActorMessageParser::string(std::string& value)
+{
+    if (InActor() && m_field == FIELD_ID && ActorIdToNodeId(value.data(), value.size(), m_actor.nodeId))
+    {
+        m_fields |= HAS_ID;
+    }
+    m_actorsKey = false;
+    return true;
+}
+
+bool ActorMessageParser::start_object(size_t elements)
+{
+    m_depth++;
+    if (InActor())
+    {
+        m_actor = ActorSample();
+        m_fields = 0;
+        m_field = FIELD_OTHER;
+    }
+    m_actorsKey = false;
+    return true;
+}
+
+bool ActorMessageParser::key(std::string& name)
+{
+    if (m_depth == 1)
+    {
+        if (name == "event_type")
+        {
+            m_event = true;
+            return false;
+        }
+        m_actorsKey = name == "actors";
+    }
+    else if (InActor())
+    {
+        if (name == "id")
+        {
+            m_field = FIELD_ID;
+        }
+        else if (name.size() == 1 && name[0] >= 'x' && name[0] <= 'z')
+        {
+            m_field = static_cast<Field>(FIELD_X + (name[0] - 'x'));
+        }
+        else
+        {
+            m_field = FIELD_OTHER;
+        }
+    }
+    return true;
+}
+
+bool ActorMessageParser::end_object()
+{
+    if (InActor())
+    {
+        if (m_fields == HAS_ALL)
+        {
+            m_actors.push_back(m_actor);
+        }
+        else
+        {
+            m_skipped++;
+        }
+    }
+    m_depth--;
+    return true;
+}
+
+bool ActorMessageParser::start_array(size_t elements)
+{
+    m_depth++;
+    if (m_actorsKey && m_depth == 2)
+    {
+        m_actorsDepth = m_depth;
+        m_sawActors = true;
+    }
+    m_actorsKey = false;
+    return true;
+}
+
+bool ActorMessageParser::end_array()
+{
+    if (m_depth == m_actorsDepth)
+    {
+        m_actorsDepth = 0;
+    }
+    m_depth--;
+    return true;
+}
@@ -0,0 +1,133 @@
+#ifndef ACTOR_MESSAGE_PARSER_H
+#define ACTOR_MESSAGE_PARSER_H
+
+#include "ns3/vector.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * \brief Position of one actor of a ZMQ "actors" message
+ */
+struct ActorSample
+{
+    uint32_t nodeId = 0;
+    ns3::Vector position;
+    double timestamp = 0; ///< Publisher time in seconds, 0 when not sent
+};
+
+/**
+ * \brief Map a publisher actor id to a node id
+ *
+ * "uavN" is node N and "gcs" node 0.
+ *
+ * \param id The actor id
+ * \param size Length of the id
+ * \param nodeId Set to the node id
+ * \return False for an unknown or malformed id
+ */
+bool ActorIdToNodeId(const char* id, size_t size, uint32_t& nodeId);
+
+/**
+ * \brief Streaming parser of the publisher's "actors" messages
+ *
+ * Parses JSON with nlohmann's SAX interface straight from the received
+ * buffer: no copy of the message and no DOM are made, and only the
+ * "id", "x", "y" and "z" members of each entry of the top-level
+ * "actors" array are kept, in an actor array reused between messages.
+ * Parsing stops at a top-level "event_type" key, leaving application
+ * events, which are rare, to a DOM parse.
+ */
+class ActorMessageParser
+{
+public:
+    /**
+     * \brief Outcome of Parse()
+     */
+    enum Result
+    {
+        ACTORS, ///< An actors message, see GetActors()
+        OTHER,  ///< Valid JSON without actors, or an application event
+        ERROR   ///< Malformed JSON, see GetError()
+    };
+
+    ActorMessageParser();
+
+    /**
+     * \brief Parse one message body
+     * \param data The JSON text
+     * \param size Its length
+     * \return What the message holds
+     */
+    Result Parse(const char* data, size_t size);
+
+    /**
+     * \brief Get the actors of the last ACTORS message
+     *
+     * Entries with an unknown id or missing coordinates are skipped.
+     */
+    const std::vector<ActorSample>& GetActors() const { return m_actors; }
+
+    /**
+     * \brief Get the number of entries skipped in the last message
+     */
+    uint32_t GetSkipped() const { return m_skipped; }
+
+    const std::string& GetError() const { return m_error; }
+
+    // nlohmann::json SAX interface
+    bool null();
+    bool boolean(bool value);
+    bool number_integer(int64_t value);
+    bool number_unsigned(uint64_t value);
+    bool number_float(double value, const std::string& text);
+    bool string(std::string& value);
+    template <typename Binary>
+    bool binary(Binary& value) { return true; }
+    bool start_object(size_t elements);
+    bool key(std::string& name);
+    bool end_object();
+    bool start_array(size_t elements);
+    bool end_array();
+    template <typename Exception>
+    bool parse_error(size_t position, const std::string& token, const Exception& e)
+    {
+        m_error = e.what();
+        return false;
+    }
+
+private:
+    /**
+     * \brief Member of an actor entry the next value belongs to
+     */
+    enum Field
+    {
+        FIELD_OTHER,
+        FIELD_ID,
+        FIELD_X,
+        FIELD_Y,
+        FIELD_Z
+    };
+
+    /**
+     * \brief Handle a number
+     */
+    bool Number(double value);
+
+    bool InActor() const { return m_actorsDepth > 0 && m_depth == m_actorsDepth + 1; }
+
+    std::vector<ActorSample> m_actors;
+    uint32_t m_depth;        ///< Containers open
+    uint32_t m_actorsDepth;  ///< Depth of the actors array, 0 outside it
+    bool m_actorsKey;        ///< The top-level key just read is "actors"
+    bool m_sawActors;
+    bool m_event;            ///< Stopped at an "event_type" key
+    Field m_field;
+    ActorSample m_actor;     ///< Entry being parsed
+    uint8_t m_fields;        ///< Bits of the fields of m_actor seen
+    uint32_t m_skipped;
+    std::string m_error;
+};
+
+#endif
@@ -0,0 +1,159 @@
+#include "ns3/core-module.h"
+#include "actor_message_parser.h"
+#include "position_wire_format.h"
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+
+using namespace ns3;
+using json = nlohmann::json;
+
+NS_LOG_COMPONENT_DEFINE("JsonIngestBenchmark");
+
+/**
+ * Reference copy of the original ZmqReceiverApp actor parsing: string
+ * copies of the frame and body, a DOM and per-actor string lookups.
+ */
+uint32_t LegacyParse(const char* data, size_t size, const std::string& topic, std::vector<ActorSample>& actors) {
+    actors.clear();
+    std::string message = std::string(data, size);
+    json jsonData = json::parse(message.substr(topic.size() + 1));
+    if (jsonData.contains("actors")) {
+        for (auto& actor : jsonData["actors"]) {
+            std::string id = actor["id"];
+            double x = actor["x"];
+            double y = actor["y"];
+            double z = actor["z"];
+            ActorSample sample;
+            if (id.find("uav") == 0) {
+                try {
+                    sample.nodeId = static_cast<uint32_t>(std::stoi(id.substr(3)));
+                } catch (const std::exception& e) {
+                    continue;
+                }
+            } else if (id == "gcs") {
+                sample.nodeId = 0;
+            } else {
+                continue;
+            }
+            sample.position = Vector(x, y, z);
+            actors.push_back(sample);
+        }
+    }
+    return actors.size();
+}
+
+/**
+ * Messages in the publisher's format: topic, space, one actors object
+ */
+std::vector<std::string> MakeMessages(const std::string& topic, uint32_t actors, uint32_t count) {
+    std::vector<std::string> messages;
+    for (uint32_t i = 0; i < count; i++) {
+        json body;
+        body["timestamp"] = i * 0.01;
+        body["actors"] = json::array();
+        body["actors"].push_back({{"id", "gcs"}, {"x", 0.0}, {"y", 0.0}, {"z", 0.0}});
+        for (uint32_t uav = 1; uav < actors; uav++) {
+            body["actors"].push_back({{"id", "uav" + std::to_string(uav)},
+                                      {"x", uav * 10.0 + i * 0.137},
+                                      {"y", uav * -3.5 + i * 0.071},
+                                      {"z", 50.0 + (uav % 7) * 1.25}});
+        }
+        messages.push_back(topic + " " + body.dump());
+    }
+    return messages;
+}
+
+int main(int argc, char *argv[]) {
+    std::string topic = "ns3";
+    std::string file;
+    uint32_t actors = 200;
+    uint32_t iterations = 2000;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("topic", "Topic prefix of the messages", topic);
+    cmd.AddValue("file", "Recorded messages, one per line; generated when empty", file);
+    cmd.AddValue("actors", "Actors per generated message", actors);
+    cmd.AddValue("iterations", "Messages parsed per parser", iterations);
+    cmd.Parse(argc, argv);
+
+    std::vector<std::string> messages;
+    if (file.empty()) {
+        messages = MakeMessages(topic, actors, 64);
+    } else {
+        std::ifstream in(file);
+        NS_ABORT_MSG_IF(!in, "Cannot open " << file);
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.size() > topic.size()) {
+                messages.push_back(line);
+            }
+        }
+        NS_ABORT_MSG_IF(messages.empty(), "No messages in " << file);
+    }
+
+    std::vector<ActorSample> legacyActors;
+    ActorMessageParser parser;
+    uint64_t bytes = 0;
+    uint64_t legacyCount = 0;
+    uint64_t streamingCount = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++) {
+        const std::string& message = messages[i % messages.size()];
+        legacyCount += LegacyParse(message.data(), message.size(), topic, legacyActors);
+        bytes += message.size();
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++) {
+        const std::string& message = messages[i % messages.size()];
+        size_t offset = topic.size() + 1;
+        if (parser.Parse(message.data() + offset, message.size() - offset) == ActorMessageParser::ACTORS) {
+            streamingCount += parser.GetActors().size();
+        }
+    }
+    auto stop = std::chrono::steady_clock::now();
+
+    // The same positions in the binary format
+    std::vector<std::string> binaryMessages;
+    uint64_t binaryBytes = 0;
+    for (const std::string& message : messages) {
+        size_t offset = topic.size() + 1;
+        parser.Parse(message.data() + offset, message.size() - offset);
+        std::string binary = topic + ".bin ";
+        PositionWireFormat::Encode(parser.GetActors(), binary);
+        binaryMessages.push_back(binary);
+    }
+    std::vector<ActorSample> binaryActors;
+    std::string error;
+    uint64_t binaryCount = 0;
+    auto binaryStart = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++) {
+        const std::string& message = binaryMessages[i % binaryMessages.size()];
+        size_t offset = topic.size() + 5;
+        if (PositionWireFormat::Decode(reinterpret_cast<const uint8_t*>(message.data()) + offset,
+                                       message.size() - offset, binaryActors, error)) {
+            binaryCount += binaryActors.size();
+        }
+        binaryBytes += message.size();
+    }
+    auto binaryStop = std::chrono::steady_clock::now();
+
+    double legacyUs = std::chrono::duration<double>(middle - start).count() * 1e6 / iterations;
+    double streamingUs = std::chrono::duration<double>(stop - middle).count() * 1e6 / iterations;
+    double binaryUs = std::chrono::duration<double>(binaryStop - binaryStart).count() * 1e6 / iterations;
+    double mb = bytes / 1e6;
+
+    std::cout << std::fixed << std::setprecision(1)
+              << messages.size() << " messages, " << bytes / iterations << " bytes each\n"
+              << "DOM:       " << legacyUs << " us/message, "
+              << mb / (legacyUs * iterations / 1e6) << " MB/s, " << legacyCount << " actors\n"
+              << "Streaming: " << streamingUs << " us/message, "
+              << mb / (streamingUs * iterations / 1e6) << " MB/s, " << streamingCount << " actors\n"
+              << "Binary:    " << binaryUs << " us/message, " << binaryBytes / iterations
+              << " bytes each, " << binaryCount << " actors\n"
+              << "Speedup:   " << std::setprecision(2) << legacyUs / streamingUs << "x streaming, "
+              << legacyUs / binaryUs << "x binary\n";
+    return legacyCount == streamingCount && legacyCount == binaryCount ? 0 : 1;
+}
@@ -0,0 +1,155 @@
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "priority/priority-tag.h"
+#include "priority/priority-tx-queue.h"
+#include "priority/qos-config.h"
+#include <chrono>
+#include <iomanip>
+#include <map>
+#include <queue>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("PriorityQueueBenchmark");
+
+/**
+ * Reference copy of the original map-based PriorityTxQueue data path, kept
+ * here so the flat-array implementation can be compared against it.
+ */
+class LegacyMapPriorityQueue {
+public:
+    LegacyMapPriorityQueue(Ptr<QosConfig> qos, uint32_t cycleBudget)
+        : m_qosConfig(qos), m_cycleBudget(cycleBudget) {
+        for(uint8_t i = 0; i < qos->GetNumPriorities(); i++) {
+            m_priorityBudgets[i] = (qos->GetPriorityBandwidth(i) * m_cycleBudget) / 100;
+        }
+    }
+
+    bool Enqueue(Ptr<Packet> p) {
+        PriorityTag priorityTag;
+        bool found = p->PeekPacketTag(priorityTag);
+        uint8_t priority = found ? priorityTag.GetPriority() : 2;
+        m_queues[priority].push(p);
+        return true;
+    }
+
+    Ptr<Packet> Dequeue() {
+        uint32_t totalSent = 0;
+        for (const auto& counter : m_bytesSentThisCycle) {
+            totalSent += counter.second;
+        }
+        if (totalSent >= m_cycleBudget) {
+            for(auto& counter : m_bytesSentThisCycle) {
+                counter.second = 0;
+            }
+            return nullptr;
+        }
+        for (uint8_t prio = 0; prio < m_qosConfig->GetNumPriorities(); ++prio) {
+            auto queueIt = m_queues.find(prio);
+            if (queueIt == m_queues.end() || queueIt->second.empty()) {
+                continue;
+            }
+            uint32_t remainingBudget = m_priorityBudgets[prio] - m_bytesSentThisCycle[prio];
+            if (remainingBudget > 0) {
+                Ptr<Packet> p = queueIt->second.front();
+                uint32_t pktSize = p->GetSize();
+                if (pktSize <= remainingBudget) {
+                    queueIt->second.pop();
+                    m_bytesSentThisCycle[prio] += pktSize;
+                    return p;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+private:
+    Ptr<QosConfig> m_qosConfig;
+    uint32_t m_cycleBudget;
+    std::map<uint8_t, std::queue<Ptr<Packet>>> m_queues;
+    std::map<uint8_t, uint32_t> m_bytesSentThisCycle;
+    std::map<uint8_t, uint32_t> m_priorityBudgets;
+};
+
+/**
+ * Push the packet set through the queue in bursts of burstSize and drain
+ * it completely after every burst. Returns the elapsed wall-clock time.
+ */
+template <typename QueueT>
+double RunBenchmark(QueueT& queue, const std::vector<Ptr<Packet>>& packets,
+                    uint32_t rounds, uint32_t burstSize, uint64_t& dequeued) {
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < packets.size(); i += burstSize) {
+            size_t end = std::min(packets.size(), i + burstSize);
+            size_t pending = 0;
+            for (size_t j = i; j < end; j++) {
+                pending += queue.Enqueue(packets[j]) ? 1 : 0;
+            }
+            uint32_t stalls = 0;
+            while (pending > 0) {
+                if (queue.Dequeue()) {
+                    pending--;
+                    dequeued++;
+                    stalls = 0;
+                } else if (++stalls > 1000) {
+                    NS_FATAL_ERROR("Queue stalled; cycleBudget too small for the packet sizes");
+                }
+            }
+        }
+    }
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(stop - start).count();
+}
+
+int main(int argc, char *argv[]) {
+    uint32_t numPackets = 100000;
+    uint32_t rounds = 10;
+    uint32_t burstSize = 64;
+    uint32_t cycleBudget = 12500000;
+    std::string scheduler = "StrictBudget";
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("packets", "Number of distinct packets per round", numPackets);
+    cmd.AddValue("rounds", "Number of rounds over the packet set", rounds);
+    cmd.AddValue("burst", "Packets enqueued before the queue is drained", burstSize);
+    cmd.AddValue("cycleBudget", "Cycle budget in bytes", cycleBudget);
+    cmd.AddValue("scheduler", "PriorityTxQueue engine: StrictBudget, Drr or Wfq", scheduler);
+    cmd.Parse(argc, argv);
+
+    Ptr<QosConfig> qosConfig = CreateObject<QosConfig>();
+
+    // Mixed traffic: mostly video sized packets plus small control/telemetry
+    std::vector<Ptr<Packet>> packets;
+    packets.reserve(numPackets);
+    Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable>();
+    for (uint32_t i = 0; i < numPackets; i++) {
+        uint8_t priority = static_cast<uint8_t>(rng->GetInteger(0, qosConfig->GetNumPriorities() - 1));
+        uint32_t size = priority >= 2 ? 1400 : 100;
+        Ptr<Packet> p = Create<Packet>(size);
+        p->AddPacketTag(PriorityTag(priority));
+        packets.push_back(p);
+    }
+
+    LegacyMapPriorityQueue legacy(qosConfig, cycleBudget);
+    uint64_t legacyDequeued = 0;
+    double legacyTime = RunBenchmark(legacy, packets, rounds, burstSize, legacyDequeued);
+
+    Ptr<PriorityTxQueue> flat = CreateObject<PriorityTxQueue>();
+    flat->SetAttribute("Scheduler", StringValue(scheduler));
+    flat->SetMaxSize(QueueSize(QueueSizeUnit::PACKETS, burstSize));
+    flat->SetCycleBudget(cycleBudget);
+    flat->SetQosConfig(qosConfig);
+    uint64_t flatDequeued = 0;
+    double flatTime = RunBenchmark(*flat, packets, rounds, burstSize, flatDequeued);
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "map-based queue:   " << legacyDequeued << " packets, "
+              << legacyTime * 1e9 / legacyDequeued << " ns/packet\n"
+              << "flat-array queue:  " << flatDequeued << " packets, "
+              << flatTime * 1e9 / flatDequeued << " ns/packet\n"
+              << "speedup:           " << std::setprecision(2) << legacyTime / flatTime << "x\n";
+
+    Simulator::Destroy();
+    return 0;
+}
@@ -0,0 +1,138 @@
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "priority/priority-tag.h"
+#include "priority/priority-tx-queue.h"
+#include "priority/qos-config.h"
+#include <chrono>
+#include <iomanip>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("PriorityTagBenchmark");
+
+/**
+ * Reference copy of the original PriorityTag, with logging accessors that
+ * are not inlined, kept here so the fast path can be compared against it.
+ */
+class LegacyPriorityTag : public Tag {
+public:
+    static TypeId GetTypeId() {
+        static TypeId tid = TypeId("ns3::LegacyPriorityTag")
+            .SetParent<Tag>()
+            .AddConstructor<LegacyPriorityTag>();
+        return tid;
+    }
+    TypeId GetInstanceTypeId() const override { return GetTypeId(); }
+
+    LegacyPriorityTag() : m_priority(2) {}
+    LegacyPriorityTag(uint8_t priority) : m_priority(priority) {}
+
+    void Serialize(TagBuffer buf) const override {
+        NS_LOG_DEBUG("Serialized Priority " << m_priority);
+        buf.WriteU8(m_priority);
+    }
+    void Deserialize(TagBuffer buf) override {
+        m_priority = buf.ReadU8();
+        NS_LOG_DEBUG("Deserialized priority: " << (int)m_priority);
+    }
+    uint32_t GetSerializedSize() const override { return 1; }
+    void Print(std::ostream &os) const override { os << "Priority=" << (int)m_priority; }
+
+    uint8_t GetPriority() const __attribute__((noinline)) {
+        NS_LOG_DEBUG("Getting priority: " << (int)m_priority);
+        return m_priority;
+    }
+
+private:
+    uint8_t m_priority;
+};
+
+/**
+ * Packets offered at a fixed simulated rate; every packet is tagged and
+ * classified the way the selected path does it.
+ */
+struct TagWorkload {
+    enum Path { BASELINE, LEGACY, FAST };
+
+    Path path;
+    Time interval;
+    uint64_t remaining;
+    uint32_t numClasses;
+    Ptr<PriorityTxQueue> queue;
+    uint64_t checksum = 0;
+
+    void Send() {
+        uint8_t priority = static_cast<uint8_t>(remaining & 3);
+        Ptr<Packet> p = Create<Packet>(priority >= 2 ? 1400 : 100);
+        switch (path) {
+        case BASELINE:
+            checksum += priority;
+            break;
+        case LEGACY: {
+            p->AddPacketTag(LegacyPriorityTag(priority));
+            LegacyPriorityTag tag;
+            bool found = p->PeekPacketTag(tag);
+            uint8_t value = found ? tag.GetPriority() : 2;
+            checksum += value < numClasses ? value : numClasses - 1;
+            break;
+        }
+        case FAST:
+            p->AddPacketTag(PriorityTag(priority));
+            checksum += queue->Classify(p);
+            break;
+        }
+        if (--remaining > 0) {
+            Simulator::Schedule(interval, &TagWorkload::Send, this);
+        }
+    }
+};
+
+/**
+ * Run the workload in the simulator and return the wall-clock time.
+ */
+double RunWorkload(TagWorkload& workload) {
+    auto start = std::chrono::steady_clock::now();
+    Simulator::Schedule(Seconds(0), &TagWorkload::Send, &workload);
+    Simulator::Run();
+    auto stop = std::chrono::steady_clock::now();
+    Simulator::Destroy();
+    return std::chrono::duration<double>(stop - start).count();
+}
+
+int main(int argc, char *argv[]) {
+    uint64_t rate = 1000000;
+    double seconds = 1.0;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("rate", "Offered packets per simulated second", rate);
+    cmd.AddValue("seconds", "Simulated duration", seconds);
+    cmd.Parse(argc, argv);
+
+    Ptr<QosConfig> qosConfig = CreateObject<QosConfig>();
+    Ptr<PriorityTxQueue> queue = CreateObject<PriorityTxQueue>();
+    queue->SetQosConfig(qosConfig);
+
+    uint64_t packets = static_cast<uint64_t>(rate * seconds);
+    double wall[3];
+    for (int path = TagWorkload::BASELINE; path <= TagWorkload::FAST; path++) {
+        TagWorkload workload;
+        workload.path = static_cast<TagWorkload::Path>(path);
+        workload.interval = Seconds(1.0 / rate);
+        workload.remaining = packets;
+        workload.numClasses = qosConfig->GetNumPriorities();
+        workload.queue = queue;
+        wall[path] = RunWorkload(workload);
+        NS_LOG_INFO("Path " << path << " checksum " << workload.checksum);
+    }
+
+    double baseline = wall[TagWorkload::BASELINE] * 1e9 / packets;
+    double legacy = wall[TagWorkload::LEGACY] * 1e9 / packets - baseline;
+    double fast = wall[TagWorkload::FAST] * 1e9 / packets - baseline;
+    std::cout << std::fixed << std::setprecision(1)
+              << packets << " packets at " << rate << " packets/s simulated\n"
+              << "event + packet baseline: " << baseline << " ns/packet\n"
+              << "legacy tag + classify:   " << legacy << " ns/packet\n"
+              << "fast tag + classify:     " << fast << " ns/packet\n"
+              << "speedup:                 " << std::setprecision(2) << legacy / fast << "x\n";
+    return 0;
+}
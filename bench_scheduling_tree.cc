@@ -0,0 +1,70 @@
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "priority/hierarchical-tx-queue.h"
+#include "priority/priority-tag.h"
+#include <chrono>
+#include <iomanip>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("SchedulingTreeBenchmark");
+
+/**
+ * Tree of one WFQ root and one STRICT node per UAV with four priority
+ * leaves; UAV n has weight 1 + n % 3.
+ */
+SchedulingTree BuildFleetTree(uint32_t uavs) {
+    SchedulingTree tree;
+    for (uint32_t uav = 0; uav < uavs; uav++) {
+        uint32_t node = tree.AddNode(SchedulingTree::ROOT, 1 + uav % 3, SchedulingTree::STRICT);
+        for (uint8_t prio = 0; prio < 4; prio++) {
+            tree.AddLeaf(node, 1, static_cast<uint16_t>(uav), prio);
+        }
+    }
+    return tree;
+}
+
+int main(int argc, char *argv[]) {
+    uint32_t packets = 1000000;
+    uint32_t backlog = 16;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("packets", "Packets dequeued per tree size", packets);
+    cmd.AddValue("backlog", "Packets kept queued per UAV", backlog);
+    cmd.Parse(argc, argv);
+
+    std::cout << std::fixed << std::setprecision(1);
+    for (uint32_t uavs : {4u, 64u, 1024u, 4096u}) {
+        Ptr<HierarchicalTxQueue> queue = CreateObject<HierarchicalTxQueue>();
+        queue->SetMaxSize(QueueSize(QueueSizeUnit::PACKETS, uavs * backlog + 1));
+        queue->SetSchedulingTree(BuildFleetTree(uavs));
+
+        // One packet per UAV and priority rotates through the queue
+        std::vector<Ptr<Packet>> pool;
+        for (uint32_t uav = 0; uav < uavs; uav++) {
+            for (uint32_t i = 0; i < backlog; i++) {
+                Ptr<Packet> p = Create<Packet>(i % 4 >= 2 ? 1400 : 100);
+                p->AddPacketTag(PriorityTag(i % 4, static_cast<uint16_t>(uav)));
+                pool.push_back(p);
+                queue->Enqueue(p);
+            }
+        }
+
+        std::vector<uint64_t> bytes(uavs, 0);
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < packets; i++) {
+            Ptr<Packet> p = queue->Dequeue();
+            PriorityTag tag;
+            p->PeekPacketTag(tag);
+            bytes[tag.GetFlowGroup()] += p->GetSize();
+            queue->Enqueue(p);
+        }
+        auto stop = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double>(stop - start).count() * 1e9 / packets;
+
+        std::cout << uavs * 4 << " leaves: " << ns << " ns/packet (dequeue + enqueue)"
+                  << ", bytes of UAVs 0/1/2 (weights 1/2/3): "
+                  << bytes[0] << "/" << bytes[1] << "/" << bytes[2] << "\n";
+    }
+    return 0;
+}
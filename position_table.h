@@ -0,0 +1,139 @@
+#ifndef POSITION_TABLE_H
+#define POSITION_TABLE_H
+
+#include "ns3/vector.h"
+#include "spsc_queue.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+/**
+ * \brief Last-writer-wins table of node positions shared by two threads
+ *
+ * The producer thread Store()s positions as they arrive and the consumer
+ * thread Apply()s them periodically. Each node has one slot, so a
+ * position overwrites the one not applied yet and Apply() sees at most
+ * one, the latest, per node. Slots are seqlocks: the consumer retries
+ * a read that overlapped a write. Nodes are queued for Apply() in an
+ * SpscQueue the first time they become dirty, so a tick costs O(updated
+ * nodes) rather than O(nodes), and nothing is locked.
+ *
+ * Exactly one thread may call Store() and exactly one Apply().
+ */
+class PositionTable
+{
+public:
+    /**
+     * \param nodes Number of nodes, ids from 0 to nodes - 1
+     */
+    explicit PositionTable(uint32_t nodes)
+        : m_slots(new Slot[nodes]),
+          m_nodes(nodes),
+          m_dirty(nodes),
+          m_stored(0),
+          m_applied(0)
+    {
+    }
+
+    uint32_t GetNNodes() const { return m_nodes; }
+
+    /**
+     * \brief Record the latest position of a node, from the producer thread
+     * \param node The node id
+     * \param position The position
+     * \return False if the node is outside the table
+     */
+    bool Store(uint32_t node, const ns3::Vector& position)
+    {
+        if (node >= m_nodes)
+        {
+            return false;
+        }
+        Slot& slot = m_slots[node];
+        uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+        slot.seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.x.store(position.x, std::memory_order_relaxed);
+        slot.y.store(position.y, std::memory_order_relaxed);
+        slot.z.store(position.z, std::memory_order_relaxed);
+        slot.seq.store(seq + 2, std::memory_order_release);
+
+        if (!slot.dirty.exchange(true, std::memory_order_acq_rel))
+        {
+            // At most one entry per node is queued, so this always fits
+            m_dirty.TryPush(node);
+        }
+        m_stored.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * \brief Hand the latest position of every updated node to a function,
+     *        from the consumer thread
+     * \param apply Called as apply(node, position)
+     * \return The number of nodes updated
+     */
+    template <typename F>
+    uint32_t Apply(F apply)
+    {
+        uint32_t updated = 0;
+        uint32_t node;
+        while (m_dirty.TryPop(node))
+        {
+            Slot& slot = m_slots[node];
+            // Cleared before reading, so a newer Store() queues the node again
+            slot.dirty.store(false, std::memory_order_release);
+            ns3::Vector position;
+            uint32_t before;
+            uint32_t after;
+            do
+            {
+                before = slot.seq.load(std::memory_order_acquire);
+                position.x = slot.x.load(std::memory_order_relaxed);
+                position.y = slot.y.load(std::memory_order_relaxed);
+                position.z = slot.z.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                after = slot.seq.load(std::memory_order_relaxed);
+            } while (before != after || (before & 1));
+            if (before == slot.applied)
+            {
+                // Read by the previous pop already, between its clear and read
+                continue;
+            }
+            slot.applied = before;
+            apply(node, position);
+            updated++;
+        }
+        m_applied += updated;
+        return updated;
+    }
+
+    /**
+     * \brief Get the number of positions stored
+     */
+    uint64_t GetStored() const { return m_stored.load(std::memory_order_relaxed); }
+
+    /**
+     * \brief Get the number of positions applied, from the consumer thread
+     */
+    uint64_t GetApplied() const { return m_applied; }
+
+private:
+    struct Slot
+    {
+        std::atomic<uint32_t> seq{0}; ///< Odd while a write is in progress
+        std::atomic<double> x{0};
+        std::atomic<double> y{0};
+        std::atomic<double> z{0};
+        std::atomic<bool> dirty{false}; ///< Stored but not applied yet
+        uint32_t applied = 0;           ///< Sequence last applied, consumer only
+    };
+
+    std::unique_ptr<Slot[]> m_slots;
+    uint32_t m_nodes;
+    SpscQueue<uint32_t> m_dirty;   ///< Nodes with a position to apply
+    std::atomic<uint64_t> m_stored;
+    uint64_t m_applied;
+};
+
+#endif
@@ -0,0 +1,120 @@
+#include "position_wire_format.h"
+#include <cstring>
+
+namespace PositionWireFormat
+{
+
+namespace {
+
+uint16_t ReadU16(const uint8_t* p)
+{
+    return static_cast<uint16_t>(p[0] | p[1] << 8);
+}
+
+uint32_t ReadU32(const uint8_t* p)
+{
+    return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+           static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+}
+
+uint64_t ReadU64(const uint8_t* p)
+{
+    return static_cast<uint64_t>(ReadU32(p)) | static_cast<uint64_t>(ReadU32(p + 4)) << 32;
+}
+
+float ReadF32(const uint8_t* p)
+{
+    uint32_t bits = ReadU32(p);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+double ReadF64(const uint8_t* p)
+{
+    uint64_t bits = ReadU64(p);
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void WriteU16(std::string& out, uint16_t value)
+{
+    out.push_back(static_cast<char>(value));
+    out.push_back(static_cast<char>(value >> 8));
+}
+
+void WriteU32(std::string& out, uint32_t value)
+{
+    WriteU16(out, static_cast<uint16_t>(value));
+    WriteU16(out, static_cast<uint16_t>(value >> 16));
+}
+
+void WriteF32(std::string& out, float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    WriteU32(out, bits);
+}
+
+void WriteF64(std::string& out, double value)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    WriteU32(out, static_cast<uint32_t>(bits));
+    WriteU32(out, static_cast<uint32_t>(bits >> 32));
+}
+
+} // namespace
+
+void Encode(const std::vector<ActorSample>& actors, std::string& out)
+{
+    out.reserve(out.size() + HEADER_SIZE + actors.size() * RECORD_SIZE);
+    WriteU32(out, MAGIC);
+    WriteU16(out, VERSION);
+    WriteU16(out, 0);
+    WriteU32(out, static_cast<uint32_t>(actors.size()));
+    for (const ActorSample& actor : actors)
+    {
+        WriteU32(out, actor.nodeId);
+        WriteF32(out, static_cast<float>(actor.position.x));
+        WriteF32(out, static_cast<float>(actor.position.y));
+        WriteF32(out, static_cast<float>(actor.position.z));
+        WriteF64(out, actor.timestamp);
+    }
+}
+
+bool Decode(const uint8_t* data, size_t size, std::vector<ActorSample>& actors, std::string& error)
+{
+    actors.clear();
+    if (size < HEADER_SIZE || ReadU32(data) != MAGIC)
+    {
+        error = "Not a binary position message";
+        return false;
+    }
+    if (ReadU16(data + 4) != VERSION)
+    {
+        error = "Unsupported binary position version " + std::to_string(ReadU16(data + 4));
+        return false;
+    }
+    uint32_t count = ReadU32(data + 8);
+    if ((size - HEADER_SIZE) / RECORD_SIZE < count)
+    {
+        error = "Binary position message truncated, " + std::to_string(count) + " records announced";
+        return false;
+    }
+    actors.resize(count);
+    const uint8_t* record = data + HEADER_SIZE;
+    for (ActorSample& actor : actors)
+    {
+        actor.nodeId = ReadU32(record);
+        actor.position.x = ReadF32(record + 4);
+        actor.position.y = ReadF32(record + 8);
+        actor.position.z = ReadF32(record + 12);
+        actor.timestamp = ReadF64(record + 16);
+        record += RECORD_SIZE;
+    }
+    return true;
+}
+
+} // namespace PositionWireFormat
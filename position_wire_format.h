@@ -0,0 +1,50 @@
+#ifndef POSITION_WIRE_FORMAT_H
+#define POSITION_WIRE_FORMAT_H
+
+#include "actor_message_parser.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * \brief Binary position update, the compact alternative to JSON actors
+ *
+ * A message is a 12-byte header followed by packed 24-byte records, all
+ * little-endian:
+ *
+ *     header:  uint32 magic "UAVP", uint16 version, uint16 flags (0),
+ *              uint32 record count
+ *     record:  uint32 node id, float32 x, y, z, float64 timestamp (s)
+ *
+ * Node ids are numeric, so no actor id strings are parsed. Publishers
+ * send it under the receiver's binary topic, see ZmqReceiverApp.
+ */
+namespace PositionWireFormat
+{
+
+constexpr uint32_t MAGIC = 0x50564155; ///< "UAVP" read as little-endian
+constexpr uint16_t VERSION = 1;
+constexpr size_t HEADER_SIZE = 12;
+constexpr size_t RECORD_SIZE = 24;
+
+/**
+ * \brief Append the encoding of positions to a buffer
+ * \param actors The positions
+ * \param out The buffer
+ */
+void Encode(const std::vector<ActorSample>& actors, std::string& out);
+
+/**
+ * \brief Decode a message
+ * \param data The message body
+ * \param size Its length
+ * \param actors Receives the positions, cleared first
+ * \param error Set when the message is rejected
+ * \return False for a bad header or a truncated message
+ */
+bool Decode(const uint8_t* data, size_t size, std::vector<ActorSample>& actors, std::string& error);
+
+} // namespace PositionWireFormat
+
+#endif
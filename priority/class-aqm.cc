@@ -0,0 +1,138 @@
+#include "class-aqm.h"
+#include "ns3/log.h"
+#include "ns3/random-variable-stream.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("ClassAqm");
+
+namespace {
+// PIE controller gains from RFC 8033, in 1/s
+constexpr double PIE_ALPHA = 0.125;
+constexpr double PIE_BETA = 1.25;
+} // namespace
+
+ClassAqm::ClassAqm()
+    : m_mode(NONE),
+      m_count(0),
+      m_lastCount(0),
+      m_dropping(false),
+      m_dropProb(0.0)
+{
+}
+
+void ClassAqm::SetMode(Mode mode) {
+    *this = ClassAqm();
+    m_mode = mode;
+}
+
+ClassAqm::Mode ClassAqm::GetMode() const {
+    return m_mode;
+}
+
+bool ClassAqm::DropOnEnqueue(const Parameters& params, Time now, uint32_t backlog,
+                             Ptr<UniformRandomVariable> rng) {
+    if(m_mode != PIE) {
+        return false;
+    }
+    if(backlog == 0) {
+        m_qDelay = Time(0);
+    }
+    if(now - m_lastUpdate >= params.pieUpdate) {
+        PieUpdate(params, now);
+    }
+    if(backlog == 0) {
+        // An empty sub-queue restarts with a full burst allowance
+        if(m_dropProb == 0.0) {
+            m_burstAllowance = params.pieMaxBurst;
+        }
+        return false;
+    }
+    if(m_burstAllowance.IsStrictlyPositive()) {
+        return false;
+    }
+    if((m_qDelayOld < params.pieTarget / 2 && m_dropProb < 0.2) || backlog <= 2 * params.mtu) {
+        return false;
+    }
+    return rng->GetValue() < m_dropProb;
+}
+
+bool ClassAqm::DropOnDequeue(const Parameters& params, Time now, Time sojourn, uint32_t backlog) {
+    if(m_mode == PIE) {
+        m_qDelay = sojourn;
+        return false;
+    }
+    if(m_mode != CODEL) {
+        return false;
+    }
+
+    bool okToDrop = CodelOkToDrop(params, now, sojourn, backlog);
+    if(m_dropping) {
+        if(!okToDrop) {
+            m_dropping = false;
+            return false;
+        }
+        if(now >= m_dropNext) {
+            m_count++;
+            m_dropNext += params.codelInterval / std::sqrt(static_cast<double>(m_count));
+            return true;
+        }
+        return false;
+    }
+    if(okToDrop) {
+        // Resume near the previous drop rate if the last dropping state was recent
+        uint32_t delta = m_count - m_lastCount;
+        m_count = (delta > 1 && now - m_dropNext < params.codelInterval * 16) ? delta : 1;
+        m_lastCount = m_count;
+        m_dropNext = now + params.codelInterval / std::sqrt(static_cast<double>(m_count));
+        m_dropping = true;
+        return true;
+    }
+    return false;
+}
+
+bool ClassAqm::CodelOkToDrop(const Parameters& params, Time now, Time sojourn, uint32_t backlog) {
+    if(sojourn < params.codelTarget || backlog <= params.mtu) {
+        m_firstAboveTime = Time(0);
+        return false;
+    }
+    if(m_firstAboveTime.IsZero()) {
+        m_firstAboveTime = now + params.codelInterval;
+        return false;
+    }
+    return now >= m_firstAboveTime;
+}
+
+void ClassAqm::PieUpdate(const Parameters& params, Time now) {
+    double qDelay = m_qDelay.GetSeconds();
+    double p = PIE_ALPHA * (qDelay - params.pieTarget.GetSeconds()) +
+               PIE_BETA * (qDelay - m_qDelayOld.GetSeconds());
+
+    // Auto-tuning of RFC 8033 section 5.2: small probabilities move slowly
+    if(m_dropProb < 0.000001) {
+        p /= 2048;
+    } else if(m_dropProb < 0.00001) {
+        p /= 512;
+    } else if(m_dropProb < 0.0001) {
+        p /= 128;
+    } else if(m_dropProb < 0.001) {
+        p /= 32;
+    } else if(m_dropProb < 0.01) {
+        p /= 8;
+    } else if(m_dropProb < 0.1) {
+        p /= 2;
+    }
+
+    m_dropProb = std::min(1.0, std::max(0.0, m_dropProb + p));
+    if(m_qDelay.IsZero() && m_qDelayOld.IsZero()) {
+        m_dropProb *= 0.98;
+    }
+    m_qDelayOld = m_qDelay;
+    m_burstAllowance = std::max(Time(0), m_burstAllowance - params.pieUpdate);
+    m_lastUpdate = now;
+    NS_LOG_LOGIC("PIE delay " << m_qDelay << " drop probability " << m_dropProb);
+}
+
+} // namespace ns3
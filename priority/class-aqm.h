@@ -0,0 +1,98 @@
+#ifndef CLASS_AQM_H
+#define CLASS_AQM_H
+
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+class UniformRandomVariable;
+
+/**
+ * \ingroup uav
+ * \brief Active queue management state of one priority sub-queue
+ *
+ * Implements the drop decisions of CoDel (RFC 8289), taken when a packet
+ * leaves the sub-queue, and of PIE (RFC 8033), taken when a packet
+ * arrives. PIE estimates the queueing delay from the sojourn time of the
+ * packets leaving the sub-queue instead of from the departure rate. The
+ * owning queue performs the actual drops.
+ */
+class ClassAqm
+{
+public:
+    /**
+     * \brief Available droppers
+     */
+    enum Mode {
+        NONE,
+        CODEL,
+        PIE
+    };
+
+    /**
+     * \brief Tuning shared by all sub-queues of a queue
+     */
+    struct Parameters {
+        Time codelTarget;   ///< CoDel acceptable standing delay
+        Time codelInterval; ///< CoDel sliding minimum window
+        Time pieTarget;     ///< PIE target queueing delay
+        Time pieUpdate;     ///< PIE drop probability update period
+        Time pieMaxBurst;   ///< PIE burst allowance after an idle period
+        uint32_t mtu;       ///< Backlog below which no packet is dropped
+    };
+
+    ClassAqm();
+
+    /**
+     * \brief Select the dropper and reset its state
+     * \param mode The dropper to use
+     */
+    void SetMode(Mode mode);
+    Mode GetMode() const;
+
+    /**
+     * \brief Decide whether an arriving packet is dropped (PIE)
+     * \param params The queue-wide tuning
+     * \param now Current simulation time
+     * \param backlog Bytes already queued in the sub-queue
+     * \param rng Random variable in [0, 1)
+     * \return True if the packet must be dropped before enqueue
+     */
+    bool DropOnEnqueue(const Parameters& params, Time now, uint32_t backlog,
+                       Ptr<UniformRandomVariable> rng);
+
+    /**
+     * \brief Decide whether a departing packet is dropped (CoDel)
+     * \param params The queue-wide tuning
+     * \param now Current simulation time
+     * \param sojourn Time the packet spent in the sub-queue
+     * \param backlog Bytes left in the sub-queue after the packet
+     * \return True if the packet must be dropped after dequeue
+     */
+    bool DropOnDequeue(const Parameters& params, Time now, Time sojourn, uint32_t backlog);
+
+private:
+    bool CodelOkToDrop(const Parameters& params, Time now, Time sojourn, uint32_t backlog);
+    void PieUpdate(const Parameters& params, Time now);
+
+    Mode m_mode; ///< Active dropper
+
+    // CoDel state
+    Time m_firstAboveTime; ///< When the sojourn time went above target, plus interval
+    Time m_dropNext;       ///< Next drop time while in dropping state
+    uint32_t m_count;      ///< Drops since entering the dropping state
+    uint32_t m_lastCount;  ///< Value of m_count when the last dropping state ended
+    bool m_dropping;       ///< Whether CoDel is in the dropping state
+
+    // PIE state
+    double m_dropProb;       ///< Current drop probability
+    Time m_qDelay;           ///< Latest queueing delay sample
+    Time m_qDelayOld;        ///< Queueing delay at the previous update
+    Time m_lastUpdate;       ///< Time of the last probability update
+    Time m_burstAllowance;   ///< Remaining burst allowance
+};
+
+} // namespace ns3
+
+#endif
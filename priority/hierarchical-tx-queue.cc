@@ -0,0 +1,153 @@
+#include "hierarchical-tx-queue.h"
+#include "priority-tag.h"
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/string.h"
+#include <fstream>
+#include <sstream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("HierarchicalTxQueue");
+NS_OBJECT_ENSURE_REGISTERED(HierarchicalTxQueue);
+
+TypeId HierarchicalTxQueue::GetTypeId() {
+    static TypeId tid = TypeId("ns3::HierarchicalTxQueue")
+        .SetParent<Queue<Packet>>()
+        .SetGroupName("Uav")
+        .AddConstructor<HierarchicalTxQueue>()
+        .AddAttribute("ConfigFile",
+                      "JSON file describing the scheduling tree, see SchedulingTree::LoadJson",
+                      StringValue(""),
+                      MakeStringAccessor(&HierarchicalTxQueue::SetConfigFile,
+                                         &HierarchicalTxQueue::GetConfigFile),
+                      MakeStringChecker())
+        .AddTraceSource("LeafDequeue", "A packet was sent from a leaf of the scheduling tree",
+                        MakeTraceSourceAccessor(&HierarchicalTxQueue::m_traceLeafDequeue),
+                        "ns3::HierarchicalTxQueue::LeafPacketTracedCallback");
+    return tid;
+}
+
+HierarchicalTxQueue::HierarchicalTxQueue() {
+    NS_LOG_FUNCTION(this);
+}
+
+HierarchicalTxQueue::~HierarchicalTxQueue() {
+    NS_LOG_FUNCTION(this);
+}
+
+void HierarchicalTxQueue::SetSchedulingTree(const SchedulingTree& tree) {
+    NS_ABORT_MSG_IF(!IsEmpty(), "The scheduling tree can only be replaced while the queue is empty");
+    m_tree = tree;
+    m_leaves.clear();
+    m_leaves.resize(m_tree.GetNLeaves());
+}
+
+const SchedulingTree& HierarchicalTxQueue::GetSchedulingTree() const {
+    return m_tree;
+}
+
+bool HierarchicalTxQueue::LoadJson(const std::string& text) {
+    SchedulingTree tree;
+    std::string error;
+    if(!tree.LoadJson(text, error)) {
+        NS_LOG_ERROR("Invalid scheduling tree: " << error);
+        return false;
+    }
+    SetSchedulingTree(tree);
+    return true;
+}
+
+void HierarchicalTxQueue::SetConfigFile(std::string path) {
+    m_configFile = path;
+    if(path.empty()) {
+        return;
+    }
+    std::ifstream file(path);
+    NS_ABORT_MSG_IF(!file, "Cannot open scheduling tree file " << path);
+    std::stringstream text;
+    text << file.rdbuf();
+    NS_ABORT_MSG_IF(!LoadJson(text.str()), "Invalid scheduling tree file " << path);
+}
+
+std::string HierarchicalTxQueue::GetConfigFile() const {
+    return m_configFile;
+}
+
+uint32_t HierarchicalTxQueue::Classify(Ptr<const Packet> p) const {
+    PriorityTag priorityTag; // Flow group 0, priority 2 when untagged
+    p->PeekPacketTag(priorityTag);
+    return m_tree.FindLeaf(priorityTag.GetFlowGroup(), priorityTag.GetPriority());
+}
+
+uint32_t HierarchicalTxQueue::GetLeafNPackets(uint32_t leaf) const {
+    return m_leaves.at(leaf).ring.GetSize();
+}
+
+uint32_t HierarchicalTxQueue::GetLeafNBytes(uint32_t leaf) const {
+    return m_leaves.at(leaf).bytes;
+}
+
+bool HierarchicalTxQueue::Enqueue(Ptr<Packet> p) {
+    NS_ASSERT_MSG(!m_leaves.empty(), "A scheduling tree must be set before using the queue");
+    uint32_t leaf = Classify(p);
+
+    // DoEnqueue enforces MaxSize and drops through DropBeforeEnqueue itself
+    Iterator item;
+    if(!DoEnqueue(GetContainer().end(), p, item)) {
+        NS_LOG_LOGIC("Queue full, dropping packet of leaf " << leaf);
+        return false;
+    }
+    Leaf& queue = m_leaves[leaf];
+    queue.ring.Push(item);
+    queue.bytes += p->GetSize();
+    if(queue.ring.GetSize() == 1) {
+        m_tree.Activate(leaf);
+    }
+    return true;
+}
+
+Ptr<Packet> HierarchicalTxQueue::Dequeue() {
+    int32_t leaf = m_tree.Select();
+    if(leaf < 0) {
+        return nullptr;
+    }
+    Ptr<Packet> p = DoDequeue(PopLeaf(leaf));
+    m_tree.Charge(leaf, p->GetSize(), !m_leaves[leaf].ring.IsEmpty());
+    if(!m_traceLeafDequeue.IsEmpty()) {
+        m_traceLeafDequeue(p, leaf);
+    }
+    return p;
+}
+
+Ptr<Packet> HierarchicalTxQueue::Remove() {
+    int32_t leaf = m_tree.Select();
+    if(leaf < 0) {
+        return nullptr;
+    }
+    // Removed packets are not charged
+    Ptr<Packet> p = DoRemove(PopLeaf(leaf));
+    m_tree.Charge(leaf, 0, !m_leaves[leaf].ring.IsEmpty());
+    return p;
+}
+
+Ptr<const Packet> HierarchicalTxQueue::Peek() const {
+    int32_t leaf = m_tree.Select();
+    if(leaf < 0) {
+        return nullptr;
+    }
+    return *m_leaves[leaf].ring.Front();
+}
+
+void HierarchicalTxQueue::DoDispose() {
+    m_leaves.clear();
+    Queue<Packet>::DoDispose();
+}
+
+HierarchicalTxQueue::ConstIterator HierarchicalTxQueue::PopLeaf(uint32_t leaf) {
+    ConstIterator item = m_leaves[leaf].ring.Pop();
+    m_leaves[leaf].bytes -= (*item)->GetSize();
+    return item;
+}
+
+} // namespace ns3
@@ -0,0 +1,108 @@
+#ifndef HIERARCHICAL_TX_QUEUE_H
+#define HIERARCHICAL_TX_QUEUE_H
+
+#include "ns3/queue.h"
+#include "ns3/traced-callback.h"
+#include "ring-buffer.h"
+#include "scheduling-tree.h"
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup uav
+ * \brief Transmission queue shared by many UAVs, served through a SchedulingTree
+ *
+ * Packets are classified by the flow group and priority of their
+ * PriorityTag into the leaves of the tree; untagged packets use flow
+ * group 0 and priority 2. UavApplication tags its packets with its node
+ * id as flow group also when it marks the DSCP ("UseIpTos"). With one WFQ root and one STRICT node per UAV,
+ * the link is shared by weight between UAVs and by priority within each
+ * UAV, with O(log n) work per packet in the number of leaves.
+ *
+ * The tree is given through SetSchedulingTree(), LoadJson() or the
+ * "ConfigFile" attribute (see SchedulingTree::LoadJson() for the
+ * format), and can only be replaced while the queue is empty. As in
+ * PriorityTxQueue, packets are stored in the Queue<Packet> container, so
+ * MaxSize, the statistics and the trace sources of the base class apply.
+ */
+class HierarchicalTxQueue : public Queue<Packet> {
+public:
+    static TypeId GetTypeId();
+
+    /**
+     * \brief TracedCallback signature for per-leaf packet events
+     * \param [in] packet The packet
+     * \param [in] leaf The leaf index in the scheduling tree
+     */
+    typedef void (*LeafPacketTracedCallback)(Ptr<const Packet> packet, uint32_t leaf);
+
+    HierarchicalTxQueue();
+    ~HierarchicalTxQueue() override;
+
+    /**
+     * \brief Use a scheduling tree
+     * \param tree The tree, copied; the queue must be empty
+     */
+    void SetSchedulingTree(const SchedulingTree& tree);
+    const SchedulingTree& GetSchedulingTree() const;
+
+    /**
+     * \brief Build the scheduling tree from JSON
+     * \param text The JSON text; the queue must be empty
+     * \return False, and a logged error, if the text is not a valid tree
+     */
+    bool LoadJson(const std::string& text);
+
+    /**
+     * \brief Build the scheduling tree from a JSON file
+     * \param path The file; empty to keep the current tree
+     */
+    void SetConfigFile(std::string path);
+    std::string GetConfigFile() const;
+
+    /**
+     * \brief Find the leaf a packet is queued in
+     * \param p The packet
+     * \return The leaf index
+     */
+    uint32_t Classify(Ptr<const Packet> p) const;
+
+    uint32_t GetLeafNPackets(uint32_t leaf) const;
+    uint32_t GetLeafNBytes(uint32_t leaf) const;
+
+    bool Enqueue(Ptr<Packet> p) override;
+    Ptr<Packet> Dequeue() override;
+    Ptr<Packet> Remove() override;
+    Ptr<const Packet> Peek() const override;
+
+protected:
+    void DoDispose() override;
+
+private:
+    /**
+     * \brief Queued packets of a leaf
+     */
+    struct Leaf {
+        RingBuffer<ConstIterator> ring{4}; ///< Packets in the base container, oldest first
+        uint32_t bytes = 0;                ///< Bytes queued
+    };
+
+    /**
+     * \brief Remove the head packet of a leaf from its ring
+     * \param leaf The leaf index
+     * \return The packet's position in the base container
+     */
+    ConstIterator PopLeaf(uint32_t leaf);
+
+    SchedulingTree m_tree;       ///< Leaf selection
+    std::vector<Leaf> m_leaves;  ///< Packets per leaf
+    std::string m_configFile;    ///< JSON file the tree was loaded from
+
+    TracedCallback<Ptr<const Packet>, uint32_t> m_traceLeafDequeue; ///< Packet sent from a leaf
+};
+
+} // namespace ns3
+
+#endif
@@ -0,0 +1,400 @@
+#include "priority-queue-disc.h"
+#include "priority-tag.h"
+#include "ns3/abort.h"
+#include "ns3/boolean.h"
+#include "ns3/enum.h"
+#include "ns3/log.h"
+#include "ns3/net-device-queue-interface.h"
+#include "ns3/object-factory.h"
+#include "ns3/packet-filter.h"
+#include "ns3/pointer.h"
+#include "ns3/simulator.h"
+#include "ns3/socket.h"
+#include "ns3/uinteger.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("PriorityQueueDisc");
+NS_OBJECT_ENSURE_REGISTERED(PriorityQueueDisc);
+
+namespace {
+// 802.1D user priority sent for each AcIndex (AC_BE, AC_BK, AC_VI, AC_VO)
+constexpr uint8_t AC_USER_PRIORITY[] = {0, 1, 5, 6};
+} // namespace
+
+TypeId PriorityQueueDisc::GetTypeId() {
+    static TypeId tid = TypeId("ns3::PriorityQueueDisc")
+        .SetParent<QueueDisc>()
+        .SetGroupName("Uav")
+        .AddConstructor<PriorityQueueDisc>()
+        .AddAttribute("QosConfig",
+                      "Weights and number of priorities; the QosConfig defaults "
+                      "are used when unset",
+                      PointerValue(),
+                      MakePointerAccessor(&PriorityQueueDisc::SetQosConfig,
+                                          &PriorityQueueDisc::GetQosConfig),
+                      MakePointerChecker<QosConfig>())
+        .AddAttribute("CycleBudget", "Total bytes per cycle of the StrictBudget engine",
+                      UintegerValue(12500),
+                      MakeUintegerAccessor(&PriorityQueueDisc::SetCycleBudget,
+                                           &PriorityQueueDisc::GetCycleBudget),
+                      MakeUintegerChecker<uint32_t>(1))
+        .AddAttribute("Scheduler", "The engine used to pick the next priority class",
+                      EnumValue(PriorityScheduler::STRICT_BUDGET),
+                      MakeEnumAccessor(&PriorityQueueDisc::SetSchedulerMode,
+                                       &PriorityQueueDisc::GetSchedulerMode),
+                      MakeEnumChecker(PriorityScheduler::STRICT_BUDGET, "StrictBudget",
+                                      PriorityScheduler::DRR, "Drr",
+                                      PriorityScheduler::WFQ, "Wfq",
+                                      PriorityScheduler::TOKEN_BUCKET, "TokenBucket"))
+        .AddAttribute("Quantum", "DRR quantum in bytes of the lowest weighted class",
+                      UintegerValue(1500),
+                      MakeUintegerAccessor(&PriorityQueueDisc::SetQuantum,
+                                           &PriorityQueueDisc::GetQuantum),
+                      MakeUintegerChecker<uint32_t>(1))
+        .AddAttribute("Borrowing",
+                      "Let a class that used up its cycle budget borrow the unused "
+                      "budget of idle classes (StrictBudget engine only)",
+                      BooleanValue(true),
+                      MakeBooleanAccessor(&PriorityQueueDisc::SetBorrowing,
+                                          &PriorityQueueDisc::GetBorrowing),
+                      MakeBooleanChecker())
+        .AddAttribute("LinkRate", "Link rate the TokenBucket refill rates derive from",
+                      DataRateValue(DataRate("0bps")),
+                      MakeDataRateAccessor(&PriorityQueueDisc::SetLinkRate,
+                                           &PriorityQueueDisc::GetLinkRate),
+                      MakeDataRateChecker())
+        .AddAttribute("TokenWindow",
+                      "Bucket depth of the TokenBucket engine expressed as refill time",
+                      TimeValue(MilliSeconds(10)),
+                      MakeTimeAccessor(&PriorityQueueDisc::SetTokenWindow,
+                                       &PriorityQueueDisc::GetTokenWindow),
+                      MakeTimeChecker())
+        .AddAttribute("TokenBorrowing",
+                      "Let the TokenBucket engine pay backlogged classes future tokens "
+                      "instead of idling the link; when false the class rates are enforced",
+                      BooleanValue(false),
+                      MakeBooleanAccessor(&PriorityQueueDisc::SetTokenBorrowing,
+                                          &PriorityQueueDisc::GetTokenBorrowing),
+                      MakeBooleanChecker())
+        .AddAttribute("MapToAccessCategory",
+                      "Tag packets with the Wi-Fi access category of their class "
+                      "and send them through the matching device queue",
+                      BooleanValue(false),
+                      MakeBooleanAccessor(&PriorityQueueDisc::m_mapToAc),
+                      MakeBooleanChecker());
+    return tid;
+}
+
+PriorityQueueDisc::PriorityQueueDisc()
+    : QueueDisc(QueueDiscSizePolicy::NO_LIMITS),
+      m_cycleBudget(12500),
+      m_mapToAc(false)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+PriorityQueueDisc::~PriorityQueueDisc() {
+    NS_LOG_FUNCTION(this);
+}
+
+void PriorityQueueDisc::SetQosConfig(Ptr<QosConfig> qos) {
+    if(m_qosConfig == qos) {
+        return;
+    }
+    if(m_qosConfig) {
+        m_qosConfig->TraceDisconnectWithoutContext(
+            "Changed", MakeCallback(&PriorityQueueDisc::QosConfigChanged, this));
+    }
+    m_qosConfig = qos;
+    if(m_qosConfig) {
+        m_qosConfig->TraceConnectWithoutContext(
+            "Changed", MakeCallback(&PriorityQueueDisc::QosConfigChanged, this));
+        if(IsInitialized()) {
+            QosConfigChanged(m_qosConfig);
+        }
+    }
+}
+
+Ptr<QosConfig> PriorityQueueDisc::GetQosConfig() const {
+    return m_qosConfig;
+}
+
+void PriorityQueueDisc::SetCycleBudget(uint32_t cycleBudget) {
+    m_cycleBudget = cycleBudget;
+    if(IsInitialized() && m_qosConfig) {
+        ConfigureScheduler();
+    }
+}
+
+uint32_t PriorityQueueDisc::GetCycleBudget() const {
+    return m_cycleBudget;
+}
+
+void PriorityQueueDisc::SetSchedulerMode(PriorityScheduler::Mode mode) {
+    m_scheduler.SetMode(mode);
+}
+
+PriorityScheduler::Mode PriorityQueueDisc::GetSchedulerMode() const {
+    return m_scheduler.GetMode();
+}
+
+void PriorityQueueDisc::SetQuantum(uint32_t quantum) {
+    m_scheduler.SetQuantum(quantum);
+}
+
+uint32_t PriorityQueueDisc::GetQuantum() const {
+    return m_scheduler.GetQuantum();
+}
+
+void PriorityQueueDisc::SetBorrowing(bool borrowing) {
+    m_scheduler.SetBorrowing(borrowing);
+}
+
+bool PriorityQueueDisc::GetBorrowing() const {
+    return m_scheduler.GetBorrowing();
+}
+
+void PriorityQueueDisc::SetLinkRate(DataRate rate) {
+    m_scheduler.SetLinkRate(rate.GetBitRate());
+}
+
+DataRate PriorityQueueDisc::GetLinkRate() const {
+    return DataRate(m_scheduler.GetLinkRate());
+}
+
+void PriorityQueueDisc::SetTokenWindow(Time window) {
+    m_scheduler.SetTokenWindow(window);
+}
+
+Time PriorityQueueDisc::GetTokenWindow() const {
+    return m_scheduler.GetTokenWindow();
+}
+
+void PriorityQueueDisc::SetTokenBorrowing(bool borrowing) {
+    m_scheduler.SetTokenBorrowing(borrowing);
+}
+
+bool PriorityQueueDisc::GetTokenBorrowing() const {
+    return m_scheduler.GetTokenBorrowing();
+}
+
+void PriorityQueueDisc::SetAccessCategory(uint8_t priority, AcIndex ac) {
+    NS_ABORT_MSG_IF(ac >= AC_BE_NQOS, "Not a QoS access category");
+    while(m_accessCategories.size() <= priority) {
+        m_accessCategories.push_back(DefaultAccessCategory(m_accessCategories.size()));
+    }
+    m_accessCategories[priority] = ac;
+}
+
+AcIndex PriorityQueueDisc::GetAccessCategory(uint8_t priority) const {
+    return priority < m_accessCategories.size() ? m_accessCategories[priority]
+                                                : DefaultAccessCategory(priority);
+}
+
+AcIndex PriorityQueueDisc::DefaultAccessCategory(uint8_t priority) {
+    static const AcIndex defaults[] = {AC_VO, AC_VI, AC_BE, AC_BK};
+    return priority < 4 ? defaults[priority] : AC_BK;
+}
+
+bool PriorityQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item) {
+    NS_LOG_FUNCTION(this << item);
+
+    uint8_t prio = ClassifyItem(item);
+    if(m_mapToAc) {
+        MarkAccessCategory(item, prio);
+    }
+
+    Ptr<QueueDisc> child = GetQueueDiscClass(prio)->GetQueueDisc();
+    bool wasEmpty = m_headSizes[prio].IsEmpty();
+    uint32_t size = item->GetSize();
+    // A child that refuses the packet reports the drop to this queue disc
+    bool retval = child->Enqueue(item);
+    if(retval) {
+        m_headSizes[prio].Push(size);
+    }
+    if(wasEmpty) {
+        UpdateHead(prio);
+    } else {
+        TrimHeadSizes(prio);
+    }
+    NS_LOG_LOGIC("Priority " << (int)prio << " enqueue " << (retval ? "ok" : "dropped"));
+    return retval;
+}
+
+Ptr<QueueDiscItem> PriorityQueueDisc::DoDequeue() {
+    NS_LOG_FUNCTION(this);
+
+    while(true) {
+        int32_t prio = m_scheduler.Select();
+        if(prio < 0) {
+            Time next = m_scheduler.GetFirstBacklogged() >= 0 ? m_scheduler.GetNextEligibleTime()
+                                                              : Time::Max();
+            if(next != Time::Max() && !m_wakeEvent.IsRunning()) {
+                // TokenBucket classes over their rate: run again when one
+                // has earned its head packet, as TbfQueueDisc does
+                m_wakeEvent = Simulator::Schedule(next - Simulator::Now(), &QueueDisc::Run, this);
+                NS_LOG_LOGIC("No class within its rate, waking at " << next);
+            } else {
+                NS_LOG_LOGIC("Queue empty");
+            }
+            return nullptr;
+        }
+
+        Ptr<QueueDiscItem> item = GetQueueDiscClass(prio)->GetQueueDisc()->Dequeue();
+        if(!item) {
+            // The child dropped its remaining packets (e.g. CoDel)
+            UpdateHead(prio);
+            continue;
+        }
+
+        m_scheduler.Charge(prio, item->GetSize());
+        UpdateHead(prio);
+        NS_LOG_LOGIC("Popped from priority " << prio << ": " << item);
+        return item;
+    }
+}
+
+bool PriorityQueueDisc::CheckConfig() {
+    NS_LOG_FUNCTION(this);
+
+    if(GetNInternalQueues() > 0) {
+        NS_LOG_ERROR("PriorityQueueDisc cannot have internal queues");
+        return false;
+    }
+
+    if(!m_qosConfig) {
+        SetQosConfig(CreateObject<QosConfig>());
+    }
+    uint8_t numPriorities = m_qosConfig->GetNumPriorities();
+    if(numPriorities == 0 || numPriorities > PriorityScheduler::MAX_CLASSES) {
+        NS_LOG_ERROR("PriorityQueueDisc supports 1 to "
+                     << (int)PriorityScheduler::MAX_CLASSES << " priorities");
+        return false;
+    }
+
+    if(GetNQueueDiscClasses() == 0) {
+        ObjectFactory factory;
+        factory.SetTypeId("ns3::FifoQueueDisc");
+        for(uint8_t i = 0; i < numPriorities; i++) {
+            Ptr<QueueDisc> qd = factory.Create<QueueDisc>();
+            qd->Initialize();
+            Ptr<QueueDiscClass> c = CreateObject<QueueDiscClass>();
+            c->SetQueueDisc(qd);
+            AddQueueDiscClass(c);
+        }
+    }
+
+    if(GetNQueueDiscClasses() != numPriorities) {
+        NS_LOG_ERROR("PriorityQueueDisc needs one queue disc class per priority, got "
+                     << GetNQueueDiscClasses() << " for " << (int)numPriorities);
+        return false;
+    }
+
+    if(m_scheduler.GetMode() == PriorityScheduler::TOKEN_BUCKET &&
+       m_scheduler.GetLinkRate() == 0) {
+        NS_LOG_ERROR("The TokenBucket engine needs the LinkRate attribute");
+        return false;
+    }
+
+    return true;
+}
+
+void PriorityQueueDisc::InitializeParams() {
+    NS_LOG_FUNCTION(this);
+
+    uint8_t numPriorities = m_qosConfig->GetNumPriorities();
+    ConfigureScheduler();
+
+    while(m_accessCategories.size() < numPriorities) {
+        m_accessCategories.push_back(DefaultAccessCategory(m_accessCategories.size()));
+    }
+    m_headSizes.resize(numPriorities);
+}
+
+void PriorityQueueDisc::DoDispose() {
+    NS_LOG_FUNCTION(this);
+    m_wakeEvent.Cancel();
+    SetQosConfig(nullptr);
+    QueueDisc::DoDispose();
+}
+
+void PriorityQueueDisc::ConfigureScheduler() {
+    uint8_t numPriorities = m_qosConfig->GetNumPriorities();
+    std::vector<uint32_t> weights;
+    for(uint8_t i = 0; i < numPriorities; i++) {
+        weights.push_back(m_qosConfig->GetPriorityBandwidth(i));
+    }
+    uint32_t cycleBudget = m_qosConfig->GetCycleBudget() > 0 ? m_qosConfig->GetCycleBudget()
+                                                             : m_cycleBudget;
+    m_scheduler.Configure(weights, cycleBudget);
+}
+
+void PriorityQueueDisc::QosConfigChanged(Ptr<const QosConfig> qos) {
+    NS_LOG_FUNCTION(this << qos);
+    if(!IsInitialized()) {
+        return; // InitializeParams() reads the final values
+    }
+    // The children are fixed once the queue disc runs
+    if(qos->GetNumPriorities() != GetNQueueDiscClasses()) {
+        NS_LOG_WARN("Ignoring a QosConfig with " << (int)qos->GetNumPriorities()
+                    << " priorities, the queue disc has " << GetNQueueDiscClasses());
+        return;
+    }
+    ConfigureScheduler();
+    for(uint8_t prio = 0; prio < GetNQueueDiscClasses(); prio++) {
+        UpdateHead(prio);
+    }
+}
+
+uint8_t PriorityQueueDisc::ClassifyItem(Ptr<QueueDiscItem> item) {
+    uint8_t numPriorities = static_cast<uint8_t>(GetNQueueDiscClasses());
+    int32_t prio = 2; // Default to normal
+
+    PriorityTag priorityTag;
+    if(item->GetPacket()->PeekPacketTag(priorityTag)) {
+        prio = priorityTag.GetPriority();
+    } else if(GetNPacketFilters() > 0) {
+        int32_t ret = Classify(item);
+        if(ret != PacketFilter::PF_NO_MATCH) {
+            prio = ret;
+        }
+    }
+
+    // Unknown priorities are served with the lowest configured class
+    return prio >= 0 && prio < numPriorities ? static_cast<uint8_t>(prio)
+                                             : static_cast<uint8_t>(numPriorities - 1);
+}
+
+void PriorityQueueDisc::MarkAccessCategory(Ptr<QueueDiscItem> item, uint8_t prio) {
+    AcIndex ac = m_accessCategories[prio];
+
+    // The Wi-Fi MAC derives the TID, and thus the EDCA queue, from this tag
+    SocketPriorityTag priorityTag;
+    priorityTag.SetPriority(AC_USER_PRIORITY[ac]);
+    item->GetPacket()->ReplacePacketTag(priorityTag);
+
+    Ptr<NetDeviceQueueInterface> ndqi = GetNetDeviceQueueInterface();
+    if(ndqi && ndqi->GetNTxQueues() > static_cast<std::size_t>(ac)) {
+        item->SetTxQueueIndex(ac);
+    }
+}
+
+void PriorityQueueDisc::TrimHeadSizes(uint8_t prio) {
+    RingBuffer<uint32_t>& sizes = m_headSizes[prio];
+    uint32_t held = GetQueueDiscClass(prio)->GetQueueDisc()->GetNPackets();
+    while(sizes.GetSize() > held) {
+        sizes.Pop();
+    }
+}
+
+void PriorityQueueDisc::UpdateHead(uint8_t prio) {
+    TrimHeadSizes(prio);
+    if(!m_headSizes[prio].IsEmpty()) {
+        m_scheduler.SetHead(prio, m_headSizes[prio].Front());
+    } else {
+        m_scheduler.ClearHead(prio);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,186 @@
+#ifndef PRIORITY_QUEUE_DISC_H
+#define PRIORITY_QUEUE_DISC_H
+
+#include "ns3/data-rate.h"
+#include "ns3/event-id.h"
+#include "ns3/qos-utils.h"
+#include "ns3/queue-disc.h"
+#include "priority-scheduler.h"
+#include "qos-config.h"
+#include "ring-buffer.h"
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup uav
+ * \brief Traffic-control counterpart of PriorityTxQueue
+ *
+ * Classifies packets by their PriorityTag into one child queue disc per
+ * QosConfig priority and serves the children with the same
+ * PriorityScheduler engines as PriorityTxQueue. Packets without a tag go
+ * through the attached packet filters, then default to priority 2.
+ * Unless child queue discs are added through TrafficControlHelper, a
+ * FifoQueueDisc is created for every priority; adding e.g. a CoDel child
+ * gives that class its own AQM. The children are never peeked, since
+ * QueueDisc::Peek() dequeues the head and would run the child's AQM at
+ * a near-zero sojourn: the sizes of the queued packets are recorded at
+ * enqueue instead. They are exact for FIFO-ordered children; with a
+ * reordering child such as FqCoDelQueueDisc the head size the scheduler
+ * sees is an estimate, while the bytes charged are always exact.
+ *
+ * Being a QueueDisc, it sits above the MAC and can be installed with
+ * TrafficControlHelper on any device, including Wi-Fi devices with one
+ * transmission queue per access category. With "MapToAccessCategory"
+ * enabled, each packet leaves with the SocketPriorityTag (user priority)
+ * of its class's access category and is assigned to the matching device
+ * transmission queue, so the EDCA function of the MAC follows the
+ * priority decided here. By default priorities 0..3 map to AC_VO, AC_VI,
+ * AC_BE and AC_BK; lower priorities map to AC_BK.
+ */
+class PriorityQueueDisc : public QueueDisc {
+public:
+    /**
+     * \brief Get the TypeId for this class
+     */
+    static TypeId GetTypeId();
+
+    PriorityQueueDisc();
+    ~PriorityQueueDisc() override;
+
+    /**
+     * \brief Set the QoS configuration
+     * \param qos The weights and number of priorities; must be set before
+     *        the queue disc is initialized
+     *
+     * Later weight and cycle budget changes of the config are applied
+     * while running; the number of priorities is fixed at initialization.
+     */
+    void SetQosConfig(Ptr<QosConfig> qos);
+    Ptr<QosConfig> GetQosConfig() const;
+
+    /**
+     * \brief Set the cycle budget bytes of the StrictBudget engine
+     * \param cycleBudget The size of cycle budget in bytes
+     */
+    void SetCycleBudget(uint32_t cycleBudget);
+    uint32_t GetCycleBudget() const;
+
+    /**
+     * \brief Set the scheduling engine
+     * \param mode The engine used to pick the next priority class
+     */
+    void SetSchedulerMode(PriorityScheduler::Mode mode);
+    PriorityScheduler::Mode GetSchedulerMode() const;
+
+    /**
+     * \brief Set the DRR quantum
+     * \param quantum Bytes per round of the lowest weighted class
+     */
+    void SetQuantum(uint32_t quantum);
+    uint32_t GetQuantum() const;
+
+    /**
+     * \brief Enable borrowing of idle budget between classes
+     * \param borrowing True to let exhausted classes borrow
+     */
+    void SetBorrowing(bool borrowing);
+    bool GetBorrowing() const;
+
+    /**
+     * \brief Set the link rate used by the TokenBucket engine
+     * \param rate The rate of the link below the queue disc
+     */
+    void SetLinkRate(DataRate rate);
+    DataRate GetLinkRate() const;
+
+    /**
+     * \brief Set the token bucket depth as refill time
+     * \param window The burst window of each class
+     */
+    void SetTokenWindow(Time window);
+    Time GetTokenWindow() const;
+
+    /**
+     * \brief Let the TokenBucket engine draw on future tokens instead of
+     *        idling the link
+     * \param borrowing True for a work-conserving engine; when false the
+     *        class rates are enforced and the queue disc runs again once
+     *        a class becomes eligible
+     */
+    void SetTokenBorrowing(bool borrowing);
+    bool GetTokenBorrowing() const;
+
+    /**
+     * \brief Set the Wi-Fi access category of a priority class
+     * \param priority The priority level
+     * \param ac The access category its packets are sent with
+     */
+    void SetAccessCategory(uint8_t priority, AcIndex ac);
+    AcIndex GetAccessCategory(uint8_t priority) const;
+
+private:
+    bool DoEnqueue(Ptr<QueueDiscItem> item) override;
+    Ptr<QueueDiscItem> DoDequeue() override;
+    bool CheckConfig() override;
+    void InitializeParams() override;
+    void DoDispose() override;
+
+    /**
+     * \brief Pick the priority class of a packet
+     * \param item The arriving packet
+     * \return A valid class index
+     */
+    uint8_t ClassifyItem(Ptr<QueueDiscItem> item);
+
+    /**
+     * \brief Tag a packet for the access category of its class
+     * \param item The packet
+     * \param prio Its class index
+     */
+    void MarkAccessCategory(Ptr<QueueDiscItem> item, uint8_t prio);
+
+    /**
+     * \brief Configure the scheduler from the QosConfig weights
+     */
+    void ConfigureScheduler();
+
+    /**
+     * \brief Subscription to the QosConfig "Changed" trace
+     * \param qos The changed configuration
+     */
+    void QosConfigChanged(Ptr<const QosConfig> qos);
+
+    /**
+     * \brief Drop the sizes of packets the child no longer holds
+     * \param prio The class index
+     *
+     * Drops of a FIFO-ordered child (Fifo, CoDel, PIE, RED) happen at its
+     * head or at arrival, so the oldest sizes are the ones to go.
+     */
+    void TrimHeadSizes(uint8_t prio);
+
+    /**
+     * \brief Report the current head of a child to the scheduler
+     * \param prio The class index
+     */
+    void UpdateHead(uint8_t prio);
+
+    /**
+     * \brief Default access category of a priority class
+     * \param priority The priority level
+     */
+    static AcIndex DefaultAccessCategory(uint8_t priority);
+
+    Ptr<QosConfig> m_qosConfig;   ///< QoS configuration
+    uint32_t m_cycleBudget;       ///< Total bytes per StrictBudget cycle, unless the QosConfig sets one
+    PriorityScheduler m_scheduler; ///< Class selection
+    bool m_mapToAc;               ///< Whether packets are tagged with their access category
+    EventId m_wakeEvent;          ///< Run() once a TokenBucket class becomes eligible
+    std::vector<AcIndex> m_accessCategories; ///< Access category per class
+    std::vector<RingBuffer<uint32_t>> m_headSizes; ///< Sizes of the packets each child holds, oldest first
+};
+
+} // namespace ns3
+
+#endif
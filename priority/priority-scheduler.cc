@@ -0,0 +1,496 @@
+#include "priority-scheduler.h"
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "ns3/simulator.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace ns3 {
+
+namespace {
+
+/**
+ * \brief Index of the lowest set bit
+ * \param bits A non-zero bitmap
+ * \return The bit index (0-63)
+ */
+inline uint32_t LowestSetBit(uint64_t bits) {
+    return static_cast<uint32_t>(__builtin_ctzll(bits));
+}
+
+/**
+ * \brief Next set bit after a position, wrapping around
+ * \param bits A non-zero bitmap
+ * \param after The position to start after, or -1 to start at bit 0
+ * \return The bit index (0-63)
+ */
+inline uint32_t NextSetBit(uint64_t bits, int32_t after) {
+    uint64_t higher = after < 0 ? bits : bits & ~((uint64_t(2) << after) - 1);
+    return LowestSetBit(higher != 0 ? higher : bits);
+}
+
+/// Token shortfall in bytes ignored as rounding error of the refill
+constexpr double TOKEN_EPSILON = 1e-6;
+
+} // namespace
+
+PriorityScheduler::PriorityScheduler()
+    : m_mode(STRICT_BUDGET),
+      m_quantum(1500),
+      m_borrowing(true),
+      m_defaultCeiling(100),
+      m_cycleBudget(0),
+      m_sentThisCycle(0),
+      m_occupied(0),
+      m_eligible(0),
+      m_weighted(0),
+      m_drrCurrent(-1),
+      m_borrowClass(-1),
+      m_borrowAmount(0),
+      m_virtualTime(0),
+      m_linkRate(0),
+      m_tokenWindow(MilliSeconds(10)),
+      m_tokenBorrowing(false) {
+}
+
+void PriorityScheduler::SetMode(Mode mode) {
+    m_mode = mode;
+}
+
+PriorityScheduler::Mode PriorityScheduler::GetMode() const {
+    return m_mode;
+}
+
+void PriorityScheduler::SetQuantum(uint32_t quantum) {
+    NS_ABORT_MSG_IF(quantum == 0, "DRR quantum must be positive");
+    m_quantum = quantum;
+    UpdateTokenRates();
+    std::vector<uint32_t> weights;
+    for (const ClassState& state : m_classes) {
+        weights.push_back(state.weight);
+    }
+    Configure(weights, m_cycleBudget);
+}
+
+uint32_t PriorityScheduler::GetQuantum() const {
+    return m_quantum;
+}
+
+void PriorityScheduler::SetBorrowing(bool borrowing) {
+    m_borrowing = borrowing;
+}
+
+bool PriorityScheduler::GetBorrowing() const {
+    return m_borrowing;
+}
+
+void PriorityScheduler::SetDefaultCeiling(uint32_t percent) {
+    m_defaultCeiling = percent;
+}
+
+uint32_t PriorityScheduler::GetDefaultCeiling() const {
+    return m_defaultCeiling;
+}
+
+void PriorityScheduler::SetCeiling(uint8_t cls, uint32_t percent) {
+    NS_ABORT_MSG_IF(cls >= m_classes.size(), "No class " << (int)cls << " configured");
+    ClassState& state = m_classes[cls];
+    state.ceiling = percent;
+    state.ceilBytes = static_cast<uint32_t>((uint64_t(percent) * m_cycleBudget) / 100);
+}
+
+uint32_t PriorityScheduler::GetCeiling(uint8_t cls) const {
+    NS_ASSERT(cls < m_classes.size());
+    return m_classes[cls].ceiling;
+}
+
+uint64_t PriorityScheduler::GetBytesLent(uint8_t cls) const {
+    NS_ASSERT(cls < m_classes.size());
+    return m_classes[cls].totalLent;
+}
+
+uint64_t PriorityScheduler::GetBytesBorrowed(uint8_t cls) const {
+    NS_ASSERT(cls < m_classes.size());
+    return m_classes[cls].totalBorrowed;
+}
+
+void PriorityScheduler::SetLinkRate(uint64_t bitsPerSecond) {
+    m_linkRate = bitsPerSecond;
+    UpdateTokenRates();
+}
+
+uint64_t PriorityScheduler::GetLinkRate() const {
+    return m_linkRate;
+}
+
+void PriorityScheduler::SetTokenWindow(Time window) {
+    m_tokenWindow = window;
+    UpdateTokenRates();
+}
+
+Time PriorityScheduler::GetTokenWindow() const {
+    return m_tokenWindow;
+}
+
+void PriorityScheduler::SetTokenBorrowing(bool borrowing) {
+    m_tokenBorrowing = borrowing;
+}
+
+bool PriorityScheduler::GetTokenBorrowing() const {
+    return m_tokenBorrowing;
+}
+
+Time PriorityScheduler::GetNextEligibleTime() const {
+    if (m_occupied == 0) {
+        return Time::Max();
+    }
+    double now = Simulator::Now().GetSeconds();
+    double wait = std::numeric_limits<double>::infinity();
+    uint64_t active = m_occupied;
+    while (active != 0) {
+        wait = std::min(wait, TimeToEligible(m_classes[LowestSetBit(active)], now));
+        active &= active - 1;
+    }
+    if (wait == std::numeric_limits<double>::infinity()) {
+        return Time::Max();
+    }
+    // Round up so the class has its tokens when the owner runs again
+    return Simulator::Now() + NanoSeconds(static_cast<int64_t>(std::ceil(wait * 1e9)));
+}
+
+void PriorityScheduler::Configure(const std::vector<uint32_t>& weights, uint32_t cycleBudget) {
+    NS_ABORT_MSG_IF(weights.size() > MAX_CLASSES,
+                    "At most " << (int)MAX_CLASSES << " classes are supported");
+    size_t oldSize = m_classes.size();
+    m_classes.resize(weights.size());
+    for (size_t i = oldSize; i < m_classes.size(); i++) {
+        m_classes[i] = ClassState{0, 0, 0, 0, m_defaultCeiling, 0, 0, 0, 0, 0.0, 0.0, 0, 0,
+                                  0.0, 0.0, 0.0, Simulator::Now().GetSeconds()};
+    }
+    if (weights.size() < MAX_CLASSES) {
+        m_occupied &= (uint64_t(1) << weights.size()) - 1;
+    }
+    m_cycleBudget = cycleBudget;
+
+    uint32_t minWeight = 0;
+    for (uint32_t weight : weights) {
+        if (weight > 0 && (minWeight == 0 || weight < minWeight)) {
+            minWeight = weight;
+        }
+    }
+
+    m_weighted = 0;
+    for (size_t i = 0; i < m_classes.size(); i++) {
+        ClassState& state = m_classes[i];
+        state.weight = weights[i];
+        state.budget = static_cast<uint32_t>((uint64_t(weights[i]) * cycleBudget) / 100);
+        state.ceilBytes = static_cast<uint32_t>((uint64_t(state.ceiling) * cycleBudget) / 100);
+        state.quantum = weights[i] > 0
+            ? static_cast<uint32_t>((uint64_t(m_quantum) * weights[i]) / minWeight)
+            : 0;
+        if (weights[i] > 0) {
+            m_weighted |= (uint64_t(1) << i);
+        }
+    }
+    if (m_drrCurrent >= static_cast<int32_t>(m_classes.size())) {
+        m_drrCurrent = -1;
+    }
+    UpdateTokenRates();
+    ResetCycle();
+}
+
+uint8_t PriorityScheduler::GetNClasses() const {
+    return static_cast<uint8_t>(m_classes.size());
+}
+
+bool PriorityScheduler::IsBacklogged() const {
+    return m_occupied != 0;
+}
+
+int32_t PriorityScheduler::GetFirstBacklogged() const {
+    return m_occupied != 0 ? static_cast<int32_t>(LowestSetBit(m_occupied)) : -1;
+}
+
+void PriorityScheduler::SetHead(uint8_t cls, uint32_t size) {
+    NS_ASSERT(cls < m_classes.size());
+    ClassState& state = m_classes[cls];
+    state.headSize = size;
+    if (state.weight > 0) {
+        // Self-clocked finish tag; equals the arrival-time tag for a FIFO class
+        state.headFinish = std::max(m_virtualTime, state.lastFinish) + double(size) / state.weight;
+    }
+    m_occupied |= (uint64_t(1) << cls);
+}
+
+void PriorityScheduler::ClearHead(uint8_t cls) {
+    NS_ASSERT(cls < m_classes.size());
+    m_occupied &= ~(uint64_t(1) << cls);
+    m_classes[cls].deficit = 0;
+    if (m_occupied == 0) {
+        // System is idle: restart virtual time to keep the tags small
+        m_virtualTime = 0;
+        for (ClassState& state : m_classes) {
+            state.lastFinish = 0;
+        }
+    }
+}
+
+int32_t PriorityScheduler::Select() {
+    switch (m_mode) {
+        case DRR:
+            return SelectDrr();
+        case WFQ:
+            return SelectWfq();
+        case TOKEN_BUCKET:
+            return SelectTokenBucket();
+        default:
+            return SelectStrictBudget();
+    }
+}
+
+void PriorityScheduler::Charge(uint8_t cls, uint32_t size) {
+    NS_ASSERT(cls < m_classes.size());
+    ClassState& state = m_classes[cls];
+
+    if (m_borrowClass == cls && m_borrowAmount > 0) {
+        Borrow(cls, std::min(m_borrowAmount, size));
+    }
+    m_borrowClass = -1;
+    m_borrowAmount = 0;
+
+    state.sent += size;
+    m_sentThisCycle += size;
+    UpdateEligible(cls);
+
+    state.deficit = state.deficit > size ? state.deficit - size : 0;
+    state.tokens -= size;
+
+    if (state.weight > 0) {
+        m_virtualTime = state.headFinish;
+        state.lastFinish = state.headFinish;
+    }
+}
+
+void PriorityScheduler::ResetCycle() {
+    m_eligible = 0;
+    for (size_t i = 0; i < m_classes.size(); i++) {
+        m_classes[i].sent = 0;
+        m_classes[i].lent = 0;
+        if (m_classes[i].budget > 0) {
+            m_eligible |= (uint64_t(1) << i);
+        }
+    }
+    m_sentThisCycle = 0;
+    m_borrowClass = -1;
+    m_borrowAmount = 0;
+}
+
+uint32_t PriorityScheduler::Remaining(const ClassState& state) {
+    uint32_t used = state.sent + state.lent;
+    return state.budget > used ? state.budget - used : 0;
+}
+
+void PriorityScheduler::UpdateEligible(uint8_t cls) {
+    uint64_t bit = uint64_t(1) << cls;
+    if (Remaining(m_classes[cls]) > 0) {
+        m_eligible |= bit;
+    } else {
+        m_eligible &= ~bit;
+    }
+}
+
+int32_t PriorityScheduler::FindWithinBudget() {
+    m_borrowClass = -1;
+    m_borrowAmount = 0;
+
+    // Walk backlogged classes with budget left, highest priority first
+    // A class with an untouched budget may always send one packet, so
+    // heads larger than the whole budget cannot starve
+    uint64_t candidates = m_occupied & m_eligible;
+    while (candidates != 0) {
+        uint32_t cls = LowestSetBit(candidates);
+        const ClassState& state = m_classes[cls];
+        if (state.headSize <= Remaining(state) || (state.sent == 0 && state.lent == 0)) {
+            return cls;
+        }
+        candidates &= candidates - 1;
+    }
+
+    if (!m_borrowing) {
+        return -1;
+    }
+
+    // Budget left unused by idle classes can be lent for this cycle
+    uint64_t lenders = m_eligible & ~m_occupied;
+    uint64_t lendable = 0;
+    while (lenders != 0) {
+        lendable += Remaining(m_classes[LowestSetBit(lenders)]);
+        lenders &= lenders - 1;
+    }
+    if (lendable == 0) {
+        return -1;
+    }
+
+    candidates = m_occupied;
+    while (candidates != 0) {
+        uint32_t cls = LowestSetBit(candidates);
+        const ClassState& state = m_classes[cls];
+        uint32_t needed = state.headSize - Remaining(state);
+        if (needed <= lendable && uint64_t(state.sent) + state.headSize <= state.ceilBytes) {
+            m_borrowClass = cls;
+            m_borrowAmount = needed;
+            return cls;
+        }
+        candidates &= candidates - 1;
+    }
+    return -1;
+}
+
+void PriorityScheduler::Borrow(uint8_t cls, uint32_t amount) {
+    // Lowest priority idle classes lend first
+    uint64_t lenders = m_eligible & ~m_occupied;
+    while (lenders != 0 && amount > 0) {
+        uint32_t lender = 63 - static_cast<uint32_t>(__builtin_clzll(lenders));
+        ClassState& state = m_classes[lender];
+        uint32_t take = std::min(amount, Remaining(state));
+        state.lent += take;
+        state.totalLent += take;
+        m_classes[cls].totalBorrowed += take;
+        amount -= take;
+        UpdateEligible(lender);
+        lenders &= ~(uint64_t(1) << lender);
+    }
+}
+
+void PriorityScheduler::UpdateTokenRates() {
+    double now = Simulator::Now().GetSeconds();
+    for (ClassState& state : m_classes) {
+        Refill(state, now);
+        state.rate = (double(m_linkRate) / 8.0) * state.weight / 100.0;
+        state.depth = std::max(state.rate * m_tokenWindow.GetSeconds(), double(m_quantum));
+        state.tokens = std::min(state.tokens, state.depth);
+    }
+}
+
+void PriorityScheduler::Refill(ClassState& state, double now) {
+    // A refill clock ahead of now holds tokens paid in advance
+    if (now > state.refilledAt) {
+        state.tokens = std::min(state.depth, state.tokens + state.rate * (now - state.refilledAt));
+        state.refilledAt = now;
+    }
+}
+
+double PriorityScheduler::TimeToEligible(const ClassState& state, double now) {
+    double elapsed = std::max(0.0, now - state.refilledAt);
+    double tokens = std::min(state.depth, state.tokens + state.rate * elapsed);
+    double missing = std::min(double(state.headSize), state.depth) - tokens;
+    if (missing <= TOKEN_EPSILON) {
+        return 0;
+    }
+    return state.rate > 0 ? missing / state.rate : std::numeric_limits<double>::infinity();
+}
+
+int32_t PriorityScheduler::SelectStrictBudget() {
+    if (m_occupied == 0) {
+        return -1;
+    }
+    if (m_sentThisCycle >= m_cycleBudget) {
+        ResetCycle();
+    }
+
+    int32_t cls = FindWithinBudget();
+    if (cls < 0 && m_sentThisCycle > 0) {
+        // Nobody backlogged can send in this cycle: roll over instead of idling
+        ResetCycle();
+        cls = FindWithinBudget();
+    }
+    if (cls < 0) {
+        // Head packet larger than any budget; send it rather than stall
+        cls = GetFirstBacklogged();
+    }
+    return cls;
+}
+
+int32_t PriorityScheduler::SelectDrr() {
+    uint64_t active = m_occupied & m_weighted;
+    if (active == 0) {
+        return GetFirstBacklogged();
+    }
+
+    if (m_drrCurrent < 0 || !(active & (uint64_t(1) << m_drrCurrent))) {
+        m_drrCurrent = NextSetBit(active, m_drrCurrent);
+        m_classes[m_drrCurrent].deficit += m_classes[m_drrCurrent].quantum;
+    }
+    while (m_classes[m_drrCurrent].headSize > m_classes[m_drrCurrent].deficit) {
+        m_drrCurrent = NextSetBit(active, m_drrCurrent);
+        m_classes[m_drrCurrent].deficit += m_classes[m_drrCurrent].quantum;
+    }
+    return m_drrCurrent;
+}
+
+int32_t PriorityScheduler::SelectWfq() const {
+    uint64_t active = m_occupied & m_weighted;
+    if (active == 0) {
+        return GetFirstBacklogged();
+    }
+
+    // Smallest finish tag wins, ties go to the higher priority class
+    int32_t best = -1;
+    while (active != 0) {
+        uint32_t cls = LowestSetBit(active);
+        if (best < 0 || m_classes[cls].headFinish < m_classes[best].headFinish) {
+            best = cls;
+        }
+        active &= active - 1;
+    }
+    return best;
+}
+
+int32_t PriorityScheduler::SelectTokenBucket() {
+    NS_ABORT_MSG_IF(m_linkRate == 0, "TokenBucket scheduling needs a link rate");
+    if (m_occupied == 0) {
+        return -1;
+    }
+
+    // Highest priority class whose bucket covers its head packet wins
+    double now = Simulator::Now().GetSeconds();
+    int32_t soonest = -1;
+    double soonestWait = std::numeric_limits<double>::infinity();
+    uint64_t active = m_occupied;
+    while (active != 0) {
+        uint32_t cls = LowestSetBit(active);
+        ClassState& state = m_classes[cls];
+        Refill(state, now);
+        double wait = TimeToEligible(state, now);
+        if (wait == 0) {
+            return cls;
+        }
+        if (soonest < 0 || wait < soonestWait) {
+            soonest = cls;
+            soonestWait = wait;
+        }
+        active &= active - 1;
+    }
+
+    if (!m_tokenBorrowing) {
+        return -1; // The owner restarts at GetNextEligibleTime()
+    }
+
+    // Nobody is eligible yet but the link is free: pay the backlogged
+    // classes the tokens they would earn until the first of them becomes
+    // eligible and move their refill clock past that interval, so spare
+    // capacity is shared by weight and no interval is credited twice
+    if (soonestWait != std::numeric_limits<double>::infinity()) {
+        active = m_occupied;
+        while (active != 0) {
+            ClassState& state = m_classes[LowestSetBit(active)];
+            state.tokens = std::min(state.depth, state.tokens + state.rate * soonestWait);
+            state.refilledAt = std::max(state.refilledAt, now) + soonestWait;
+            active &= active - 1;
+        }
+    }
+    return soonest;
+}
+
+} // namespace ns3
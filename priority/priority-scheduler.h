@@ -0,0 +1,293 @@
+#ifndef PRIORITY_SCHEDULER_H
+#define PRIORITY_SCHEDULER_H
+
+#include "ns3/nstime.h"
+#include <cstdint>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup uav
+ * \brief Class selection engine shared by the priority queues
+ *
+ * The scheduler never touches packets. The owning queue reports the size
+ * of each sub-queue's head packet through SetHead()/ClearHead(), asks
+ * Select() which class to serve and then reports the transmitted bytes
+ * through Charge(). Three engines are available:
+ *
+ * - STRICT_BUDGET: strict priority, each class limited to its weight
+ *   percentage of a byte cycle. When borrowing is enabled a class that
+ *   has used up its share may borrow the unused budget of idle classes,
+ *   up to its ceiling, in the style of a hierarchical token bucket. A new
+ *   cycle starts as soon as no backlogged class can send, so the engine
+ *   is work-conserving.
+ * - DRR: deficit round robin, the quantum of each class is proportional
+ *   to its weight. Work-conserving.
+ * - WFQ: self-clocked weighted fair queuing on virtual finish times.
+ *   Work-conserving.
+ * - TOKEN_BUCKET: strict priority among classes whose token bucket holds
+ *   the head packet. Each class refills at weight percent of the link
+ *   rate per simulated second, independent of load. When no bucket is
+ *   full enough Select() returns -1 and the owner restarts at
+ *   GetNextEligibleTime(), so every class is held to its rate. With token
+ *   borrowing enabled the backlogged classes are instead paid in advance
+ *   the tokens they would earn until the first of them becomes eligible,
+ *   and their refill clock moves forward by the same interval: spare
+ *   capacity is shared by weight and the link never idles.
+ *
+ * Classes with a zero weight are only served by DRR/WFQ when no weighted
+ * class is backlogged. Up to MAX_CLASSES classes are supported.
+ */
+class PriorityScheduler
+{
+public:
+    /**
+     * \brief Available scheduling engines
+     */
+    enum Mode {
+        STRICT_BUDGET,
+        DRR,
+        WFQ,
+        TOKEN_BUCKET
+    };
+
+    static constexpr uint8_t MAX_CLASSES = 64; ///< Width of the class bitmaps
+
+    PriorityScheduler();
+
+    /**
+     * \brief Set the scheduling engine
+     * \param mode The engine used by Select()
+     */
+    void SetMode(Mode mode);
+    Mode GetMode() const;
+
+    /**
+     * \brief Set the DRR quantum of the lowest weighted class
+     * \param quantum Bytes per round; other classes scale with their weight
+     */
+    void SetQuantum(uint32_t quantum);
+    uint32_t GetQuantum() const;
+
+    /**
+     * \brief Enable lending of idle budget in STRICT_BUDGET mode
+     * \param borrowing True to let exhausted classes borrow
+     */
+    void SetBorrowing(bool borrowing);
+    bool GetBorrowing() const;
+
+    /**
+     * \brief Set the ceiling given to classes created by Configure()
+     * \param percent Percentage of the cycle budget a class may reach
+     */
+    void SetDefaultCeiling(uint32_t percent);
+    uint32_t GetDefaultCeiling() const;
+
+    /**
+     * \brief Set the borrowing ceiling of a class
+     * \param cls The class index
+     * \param percent Percentage of the cycle budget the class may reach,
+     *        including borrowed bytes
+     */
+    void SetCeiling(uint8_t cls, uint32_t percent);
+    uint32_t GetCeiling(uint8_t cls) const;
+
+    /**
+     * \brief Get the total number of bytes a class has lent to others
+     * \param cls The class index
+     */
+    uint64_t GetBytesLent(uint8_t cls) const;
+
+    /**
+     * \brief Get the total number of bytes a class has borrowed
+     * \param cls The class index
+     */
+    uint64_t GetBytesBorrowed(uint8_t cls) const;
+
+    /**
+     * \brief Set the link rate the TOKEN_BUCKET refill rates derive from
+     * \param bitsPerSecond The link rate in bit/s
+     */
+    void SetLinkRate(uint64_t bitsPerSecond);
+    uint64_t GetLinkRate() const;
+
+    /**
+     * \brief Set the burst window of the token buckets
+     * \param window Depth of each bucket expressed as refill time; a bucket
+     *        always holds at least one quantum
+     */
+    void SetTokenWindow(Time window);
+    Time GetTokenWindow() const;
+
+    /**
+     * \brief Let TOKEN_BUCKET classes draw on future tokens when the link
+     *        would otherwise idle
+     * \param borrowing True for a work-conserving engine, false to enforce
+     *        the rates
+     */
+    void SetTokenBorrowing(bool borrowing);
+    bool GetTokenBorrowing() const;
+
+    /**
+     * \brief Earliest time at which a backlogged class holds enough tokens
+     *        for its head packet (TOKEN_BUCKET)
+     * \return The absolute simulation time, Simulator::Now() if a class is
+     *         already eligible, or Time::Max() if nothing is backlogged
+     */
+    Time GetNextEligibleTime() const;
+
+    /**
+     * \brief Set the class weights and derive budgets and quanta
+     * \param weights Weight per class (percentages for STRICT_BUDGET)
+     * \param cycleBudget Total bytes per STRICT_BUDGET cycle
+     *
+     * Backlog information of existing classes is kept.
+     */
+    void Configure(const std::vector<uint32_t>& weights, uint32_t cycleBudget);
+
+    /**
+     * \brief Get the number of configured classes
+     */
+    uint8_t GetNClasses() const;
+
+    /**
+     * \brief Check whether any class is backlogged
+     */
+    bool IsBacklogged() const;
+
+    /**
+     * \brief Get the highest priority backlogged class
+     * \return The class index, or -1 if all classes are empty
+     */
+    int32_t GetFirstBacklogged() const;
+
+    /**
+     * \brief Report a new head-of-line packet for a class
+     * \param cls The class index
+     * \param size Size of the packet now at the head, in bytes
+     */
+    void SetHead(uint8_t cls, uint32_t size);
+
+    /**
+     * \brief Report that a class has become empty
+     * \param cls The class index
+     */
+    void ClearHead(uint8_t cls);
+
+    /**
+     * \brief Choose the class to serve next
+     * \return The class index, or -1 if nothing may be sent now
+     *
+     * Calling Select() again without an intervening Charge() returns the
+     * same class.
+     */
+    int32_t Select();
+
+    /**
+     * \brief Account a packet taken from the head of a class
+     * \param cls The class index
+     * \param size Packet size in bytes
+     *
+     * Must be followed by SetHead() or ClearHead() for the same class.
+     */
+    void Charge(uint8_t cls, uint32_t size);
+
+    /**
+     * \brief Start a new STRICT_BUDGET cycle
+     */
+    void ResetCycle();
+
+private:
+    /**
+     * \brief Per-class scheduling state, packed for cache locality
+     */
+    struct ClassState {
+        uint32_t weight;   ///< Configured weight
+        uint32_t budget;   ///< Byte budget per cycle
+        uint32_t sent;     ///< Bytes sent in the current cycle, borrowed bytes included
+        uint32_t lent;     ///< Bytes lent to other classes in the current cycle
+        uint32_t ceiling;  ///< Borrowing ceiling in percent of the cycle
+        uint32_t ceilBytes; ///< Borrowing ceiling in bytes
+        uint32_t headSize; ///< Size of the head-of-line packet
+        uint32_t quantum;  ///< DRR quantum in bytes
+        uint32_t deficit;  ///< DRR deficit counter in bytes
+        double lastFinish; ///< WFQ finish time of the last served packet
+        double headFinish; ///< WFQ finish time of the head-of-line packet
+        uint64_t totalLent;     ///< Bytes lent since creation
+        uint64_t totalBorrowed; ///< Bytes borrowed since creation
+        double tokens;     ///< Token bucket fill in bytes, negative when in debt
+        double rate;       ///< Token refill rate in bytes/s
+        double depth;      ///< Token bucket depth in bytes
+        double refilledAt; ///< Simulation time of the last refill in seconds
+    };
+
+    /**
+     * \brief Unused own budget of a class in the current cycle
+     */
+    static uint32_t Remaining(const ClassState& state);
+
+    /**
+     * \brief Refresh the eligible bit of a class from its counters
+     */
+    void UpdateEligible(uint8_t cls);
+
+    /**
+     * \brief Find a class that can send within its budget or by borrowing
+     * \return The class index, or -1 if none can send in this cycle
+     */
+    int32_t FindWithinBudget();
+
+    /**
+     * \brief Move budget from idle classes to a borrowing class
+     * \param cls The borrowing class
+     * \param amount Bytes to borrow
+     */
+    void Borrow(uint8_t cls, uint32_t amount);
+
+    /**
+     * \brief Derive bucket rates and depths from weights and link rate
+     */
+    void UpdateTokenRates();
+
+    /**
+     * \brief Add the tokens earned since the last refill of a class
+     * \param state The class to refill
+     * \param now Current simulation time in seconds
+     */
+    static void Refill(ClassState& state, double now);
+
+    /**
+     * \brief Seconds until a class holds enough tokens for its head
+     * \param state The class to check
+     * \param now Current simulation time in seconds
+     */
+    static double TimeToEligible(const ClassState& state, double now);
+
+    int32_t SelectStrictBudget();
+    int32_t SelectDrr();
+    int32_t SelectWfq() const;
+    int32_t SelectTokenBucket();
+
+    std::vector<ClassState> m_classes; ///< State per class
+    Mode m_mode;              ///< Active engine
+    uint32_t m_quantum;       ///< DRR quantum of the lowest weighted class
+    bool m_borrowing;         ///< Whether exhausted classes may borrow
+    uint32_t m_defaultCeiling; ///< Ceiling in percent for new classes
+    uint32_t m_cycleBudget;   ///< Total bytes per cycle
+    uint32_t m_sentThisCycle; ///< Sum of ClassState::sent over all classes
+    uint64_t m_occupied;      ///< Bit i set when class i is backlogged
+    uint64_t m_eligible;      ///< Bit i set when class i has own budget left this cycle
+    uint64_t m_weighted;      ///< Bit i set when class i has a non-zero weight
+    int32_t m_drrCurrent;     ///< Class holding the DRR turn, -1 if none
+    int32_t m_borrowClass;    ///< Class chosen by Select() to borrow, -1 if none
+    uint32_t m_borrowAmount;  ///< Bytes the chosen class needs to borrow
+    double m_virtualTime;     ///< WFQ system virtual time
+    uint64_t m_linkRate;      ///< Link rate in bit/s for TOKEN_BUCKET
+    Time m_tokenWindow;       ///< Burst window of the token buckets
+    bool m_tokenBorrowing;    ///< Whether TOKEN_BUCKET pays tokens in advance
+};
+
+} // namespace ns3
+
+#endif
@@ -1,9 +1,7 @@
 #include "priority-tag.h"
-#include "ns3/log.h"
 
 namespace ns3 {
 
-NS_LOG_COMPONENT_DEFINE("PriorityTag");
 NS_OBJECT_ENSURE_REGISTERED(PriorityTag);
 
 TypeId PriorityTag::GetTypeId() {
@@ -18,30 +16,33 @@ TypeId PriorityTag::GetInstanceTypeId() const {
 }
 
 void PriorityTag::Serialize(TagBuffer buf) const {
-    NS_LOG_DEBUG("Serialized Priority " << m_priority);
     buf.WriteU8(m_priority);
+    buf.WriteU16(m_flowGroup);
 }
 
 void PriorityTag::Deserialize(TagBuffer buf) {
     m_priority = buf.ReadU8();
-    NS_LOG_DEBUG("Deserialized priority: " << (int)m_priority);
+    m_flowGroup = buf.ReadU16();
 }
 
 uint32_t PriorityTag::GetSerializedSize() const {
-    return 1; // Single byte tag
+    return 3; // Priority byte and flow group
 }
 
 void PriorityTag::Print(std::ostream &os) const {
-    os << "Priority=" << (int)m_priority;
+    os << "Priority=" << (int)m_priority << " FlowGroup=" << m_flowGroup;
 }
 
-uint8_t PriorityTag::GetPriority() const { 
-    NS_LOG_DEBUG("Getting priority: " << (int)m_priority);
-    return m_priority; 
+uint8_t PriorityTag::PriorityToDscp(uint8_t priority) {
+    static const uint8_t dscp[] = {46, 34, 0, 8}; // EF, AF41, default, CS1
+    return dscp[priority < 3 ? priority : 3];
 }
 
-void PriorityTag::SetPriority(uint8_t priority) { 
-    NS_LOG_DEBUG("Setting priority: " << (int)priority);
-    m_priority = priority; 
+uint8_t PriorityTag::DscpToPriority(uint8_t dscp) {
+    // Indexed by class selector (upper three DSCP bits): CS0 and CS2 are
+    // normal, CS1 is low, CS3/CS4 (AF3x/AF4x) high, CS5 and above (EF,
+    // network control) critical
+    static const uint8_t priority[] = {2, 3, 2, 1, 1, 0, 0, 0};
+    return priority[(dscp >> 3) & 7];
 }
 } // namespace ns3
\ No newline at end of file
@@ -15,6 +15,19 @@ namespace ns3 {
  * - 1: High
  * - 2: Normal (default)
  * - 3: Low (lowest priority)
+ *
+ * The accessors are inline and do not log, so reading the tag on the
+ * enqueue path costs one tag-list lookup and a byte copy.
+ *
+ * Since a packet tag is not part of the wire bytes, the same priorities
+ * can also be carried in the IPv4 DSCP field: PriorityToDscp() gives the
+ * code point a sender sets, DscpToPriority() the priority a queue reads
+ * back. Critical uses EF (46), High AF41 (34), Normal the default code
+ * point (0) and Low CS1 (8); other code points map by class selector.
+ *
+ * The tag also carries a flow group, e.g. the node id of the UAV that
+ * sent the packet, used by HierarchicalTxQueue to share a link between
+ * UAVs before the priority is looked at. It defaults to 0.
  */
 class PriorityTag : public Tag {
 public:
@@ -29,13 +42,15 @@ public:
     /**
      * \brief Construct with default priority (2 - Normal)
      */
-    PriorityTag() : m_priority(2) {}
+    PriorityTag() : m_priority(2), m_flowGroup(0) {}
     
     /**
      * \brief Construct with specific priority
      * \param priority The priority level (0-3)
+     * \param flowGroup The flow group
      */
-    PriorityTag(uint8_t priority) : m_priority(priority) {}
+    PriorityTag(uint8_t priority, uint16_t flowGroup = 0)
+        : m_priority(priority), m_flowGroup(flowGroup) {}
     
     // Tag serialization methods
     virtual void Serialize(TagBuffer buf) const;
@@ -47,16 +62,43 @@ public:
      * \brief Get the priority value
      * \return The priority level (0-3)
      */
-    uint8_t GetPriority() const;
+    uint8_t GetPriority() const { return m_priority; }
     
     /**
      * \brief Set the priority value
      * \param priority The priority level (0-3)
      */
-    void SetPriority(uint8_t priority);
+    void SetPriority(uint8_t priority) { m_priority = priority; }
+
+    /**
+     * \brief Get the flow group
+     * \return The flow group, 0 unless set
+     */
+    uint16_t GetFlowGroup() const { return m_flowGroup; }
+
+    /**
+     * \brief Set the flow group
+     * \param flowGroup The flow group, e.g. the sender node id
+     */
+    void SetFlowGroup(uint16_t flowGroup) { m_flowGroup = flowGroup; }
+
+    /**
+     * \brief Get the DSCP carrying a priority
+     * \param priority The priority level; values above 3 use the Low code point
+     * \return The 6-bit DSCP (shift left by 2 for the TOS byte)
+     */
+    static uint8_t PriorityToDscp(uint8_t priority);
+
+    /**
+     * \brief Get the priority carried by a DSCP
+     * \param dscp The 6-bit DSCP
+     * \return The priority level (0-3)
+     */
+    static uint8_t DscpToPriority(uint8_t dscp);
 
 private:
-    uint8_t m_priority; ///< Storage for the priority value
+    uint8_t m_priority;   ///< Storage for the priority value
+    uint16_t m_flowGroup; ///< Storage for the flow group
 };
 
 } // namespace ns3
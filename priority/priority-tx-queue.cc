@@ -1,5 +1,16 @@
 #include "priority-tx-queue.h"
 #include "priority-tag.h"
+#include "ns3/abort.h"
+#include "ns3/boolean.h"
+#include "ns3/data-rate.h"
+#include "ns3/enum.h"
+#include "ns3/log.h"
+#include "ns3/net-device.h"
+#include "ns3/nstime.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include <algorithm>
 
 
 namespace ns3 {
@@ -11,127 +22,603 @@ TypeId PriorityTxQueue::GetTypeId() {
     static TypeId tid = TypeId("ns3::PriorityTxQueue")
         .SetParent<Queue<Packet>>()
         .SetGroupName("Uav")
-        .AddConstructor<PriorityTxQueue>();
-        // .AddTraceSource("Enqueue", "Packet enqueued",
-        //               MakeTraceSourceAccessor(&PriorityTxQueue::m_traceEnqueue),
-        //               "ns3::Packet::TracedCallback")
-        // .AddTraceSource("Dequeue", "Packet dequeued",
-        //               MakeTraceSourceAccessor(&PriorityTxQueue::m_traceDequeue),
-        //               "ns3::Packet::TracedCallback");
+        .AddConstructor<PriorityTxQueue>()
+        .AddAttribute("Scheduler", "The engine used to pick the next priority class",
+                      EnumValue(PriorityScheduler::STRICT_BUDGET),
+                      MakeEnumAccessor(&PriorityTxQueue::SetSchedulerMode,
+                                       &PriorityTxQueue::GetSchedulerMode),
+                      MakeEnumChecker(PriorityScheduler::STRICT_BUDGET, "StrictBudget",
+                                      PriorityScheduler::DRR, "Drr",
+                                      PriorityScheduler::WFQ, "Wfq",
+                                      PriorityScheduler::TOKEN_BUCKET, "TokenBucket"))
+        .AddAttribute("Classifier", "Where the priority of a packet is read from",
+                      EnumValue(PriorityTxQueue::CLASSIFY_TAG),
+                      MakeEnumAccessor(&PriorityTxQueue::SetClassifier,
+                                       &PriorityTxQueue::GetClassifier),
+                      MakeEnumChecker(PriorityTxQueue::CLASSIFY_TAG, "Tag",
+                                      PriorityTxQueue::CLASSIFY_DSCP, "Dscp"))
+        .AddAttribute("Quantum", "DRR quantum in bytes of the lowest weighted class",
+                      UintegerValue(1500),
+                      MakeUintegerAccessor(&PriorityTxQueue::SetQuantum,
+                                           &PriorityTxQueue::GetQuantum),
+                      MakeUintegerChecker<uint32_t>(1))
+        .AddAttribute("Borrowing",
+                      "Let a class that used up its cycle budget borrow the unused "
+                      "budget of idle classes (StrictBudget engine only)",
+                      BooleanValue(true),
+                      MakeBooleanAccessor(&PriorityTxQueue::SetBorrowing,
+                                          &PriorityTxQueue::GetBorrowing),
+                      MakeBooleanChecker())
+        .AddAttribute("DefaultCeiling",
+                      "Percentage of the cycle budget a class may reach by borrowing, "
+                      "applied to classes created by SetQosConfig",
+                      UintegerValue(100),
+                      MakeUintegerAccessor(&PriorityTxQueue::SetDefaultCeiling,
+                                           &PriorityTxQueue::GetDefaultCeiling),
+                      MakeUintegerChecker<uint32_t>(0, 100))
+        .AddAttribute("LinkRate",
+                      "Link rate the TokenBucket refill rates derive from; "
+                      "set by AttachToDevice for devices with a DataRate attribute",
+                      DataRateValue(DataRate("0bps")),
+                      MakeDataRateAccessor(&PriorityTxQueue::SetLinkRate,
+                                           &PriorityTxQueue::GetLinkRate),
+                      MakeDataRateChecker())
+        .AddAttribute("TokenWindow",
+                      "Bucket depth of the TokenBucket engine expressed as refill time",
+                      TimeValue(MilliSeconds(10)),
+                      MakeTimeAccessor(&PriorityTxQueue::SetTokenWindow,
+                                       &PriorityTxQueue::GetTokenWindow),
+                      MakeTimeChecker())
+        .AddAttribute("Aqm",
+                      "Active queue management applied to classes created by SetQosConfig",
+                      EnumValue(ClassAqm::NONE),
+                      MakeEnumAccessor(&PriorityTxQueue::SetDefaultAqm,
+                                       &PriorityTxQueue::GetDefaultAqm),
+                      MakeEnumChecker(ClassAqm::NONE, "None",
+                                      ClassAqm::CODEL, "CoDel",
+                                      ClassAqm::PIE, "Pie"))
+        .AddAttribute("CoDelTarget", "Acceptable standing sojourn time of a CoDel class",
+                      TimeValue(MilliSeconds(5)),
+                      MakeTimeAccessor(&PriorityTxQueue::m_codelTarget),
+                      MakeTimeChecker())
+        .AddAttribute("CoDelInterval", "Window over which a CoDel class must exceed the target",
+                      TimeValue(MilliSeconds(100)),
+                      MakeTimeAccessor(&PriorityTxQueue::m_codelInterval),
+                      MakeTimeChecker())
+        .AddAttribute("PieTarget", "Target queueing delay of a PIE class",
+                      TimeValue(MilliSeconds(15)),
+                      MakeTimeAccessor(&PriorityTxQueue::m_pieTarget),
+                      MakeTimeChecker())
+        .AddAttribute("PieUpdate", "Drop probability update period of a PIE class",
+                      TimeValue(MilliSeconds(15)),
+                      MakeTimeAccessor(&PriorityTxQueue::m_pieUpdate),
+                      MakeTimeChecker())
+        .AddAttribute("AqmMtu", "Class backlog in bytes below which CoDel and PIE never drop",
+                      UintegerValue(1500),
+                      MakeUintegerAccessor(&PriorityTxQueue::m_aqmMtu),
+                      MakeUintegerChecker<uint32_t>())
+        .AddAttribute("SojournStatistics",
+                      "Count the sojourn time of sent packets in per-class histograms",
+                      BooleanValue(true),
+                      MakeBooleanAccessor(&PriorityTxQueue::SetSojournStatistics,
+                                          &PriorityTxQueue::GetSojournStatistics),
+                      MakeBooleanChecker())
+        .AddAttribute("ExpressLane",
+                      "Serve class 0 ahead of the scheduler, within ExpressRate",
+                      BooleanValue(false),
+                      MakeBooleanAccessor(&PriorityTxQueue::SetExpressLane,
+                                          &PriorityTxQueue::GetExpressLane),
+                      MakeBooleanChecker())
+        .AddAttribute("ExpressRate", "Rate cap of the express lane",
+                      DataRateValue(DataRate("1Mbps")),
+                      MakeDataRateAccessor(&PriorityTxQueue::SetExpressRate,
+                                           &PriorityTxQueue::GetExpressRate),
+                      MakeDataRateChecker())
+        .AddAttribute("ExpressBurst", "Bytes the express lane may send back to back",
+                      UintegerValue(3000),
+                      MakeUintegerAccessor(&PriorityTxQueue::SetExpressBurst,
+                                           &PriorityTxQueue::GetExpressBurst),
+                      MakeUintegerChecker<uint32_t>(1))
+        .AddTraceSource("ClassEnqueue", "Packet accepted by a priority class",
+                        MakeTraceSourceAccessor(&PriorityTxQueue::m_traceClassEnqueue),
+                        "ns3::PriorityTxQueue::ClassPacketTracedCallback")
+        .AddTraceSource("ClassDequeue", "Packet sent from a priority class",
+                        MakeTraceSourceAccessor(&PriorityTxQueue::m_traceClassDequeue),
+                        "ns3::PriorityTxQueue::ClassPacketTracedCallback")
+        .AddTraceSource("ClassDrop", "Packet dropped from a priority class",
+                        MakeTraceSourceAccessor(&PriorityTxQueue::m_traceClassDrop),
+                        "ns3::PriorityTxQueue::ClassPacketTracedCallback")
+        .AddTraceSource("SojournTime", "Time a sent packet spent in its priority class",
+                        MakeTraceSourceAccessor(&PriorityTxQueue::m_traceSojourn),
+                        "ns3::PriorityTxQueue::SojournTracedCallback");
     return tid;
 }
 
-PriorityTxQueue::PriorityTxQueue() : m_cycleBudget(12500) {
+PriorityTxQueue::PriorityTxQueue()
+    : m_classifier(CLASSIFY_TAG),
+      m_cycleBudget(12500),
+      m_defaultAqm(ClassAqm::NONE),
+      m_sojournStats(true),
+      m_expressLane(false),
+      m_expressBurst(3000),
+      m_expressTokens(3000),
+      m_expressPackets(0)
+{
+    m_classOf.fill(0);
+    m_dscpClassOf.fill(0);
+    m_uniform = CreateObject<UniformRandomVariable>();
+    // A device would never dequeue again after a nullptr from a backlogged queue
+    m_scheduler.SetTokenBorrowing(true);
 }
 
 void PriorityTxQueue::SetQosConfig(Ptr<QosConfig> qos) {
     //NS_LOG_DEBUG( "QOS: " << qos);
-    m_qosConfig = qos;
-    
-    // Calculate byte budgets for each priority
-    for(uint8_t i = 0; i < qos->GetNumPriorities(); i++) {
-        m_priorityBudgets[i] = (qos->GetPriorityBandwidth(i) * m_cycleBudget) / 100;
-        //NS_LOG_DEBUG("Priority " << (int)i << " budget: " << m_priorityBudgets[i] << " bytes");
+    if(m_qosConfig != qos) {
+        if(m_qosConfig) {
+            m_qosConfig->TraceDisconnectWithoutContext(
+                "Changed", MakeCallback(&PriorityTxQueue::QosConfigChanged, this));
+        }
+        m_qosConfig = qos;
+        m_qosConfig->TraceConnectWithoutContext(
+            "Changed", MakeCallback(&PriorityTxQueue::QosConfigChanged, this));
     }
-    ResetCycleCounters();
+    ApplyQosConfig();
 }
 
-bool PriorityTxQueue::Enqueue(Ptr<Packet> p) {
+void PriorityTxQueue::QosConfigChanged(Ptr<const QosConfig> qos) {
+    NS_LOG_DEBUG("QosConfig changed, reconfiguring " << m_queues.size() << " classes");
+    ApplyQosConfig();
+}
+
+void PriorityTxQueue::ApplyQosConfig() {
+    Ptr<QosConfig> qos = m_qosConfig;
+    uint8_t numPriorities = qos->GetNumPriorities();
+    NS_ABORT_MSG_IF(numPriorities == 0, "QosConfig must define at least one priority");
+    NS_ABORT_MSG_IF(numPriorities > PriorityScheduler::MAX_CLASSES,
+                    "PriorityTxQueue supports at most "
+                    << (int)PriorityScheduler::MAX_CLASSES << " priorities");
+
+    // Packets of classes that no longer exist move to the lowest class
+    for(size_t i = numPriorities; i < m_queues.size(); i++) {
+        while(!m_queues[i].ring.IsEmpty()) {
+            Entry entry = m_queues[i].ring.Pop();
+            m_queues[numPriorities - 1].bytes += (*entry.item)->GetSize();
+            m_queues[numPriorities - 1].ring.Push(std::move(entry));
+        }
+    }
+    size_t oldSize = m_queues.size();
+    m_queues.resize(numPriorities);
+    for(size_t i = oldSize; i < m_queues.size(); i++) {
+        m_queues[i].aqm.SetMode(m_defaultAqm);
+    }
+
+    // Calculate byte budgets for each priority; a shared cycle budget wins
+    std::vector<uint32_t> weights;
+    for(uint8_t i = 0; i < numPriorities; i++) {
+        weights.push_back(qos->GetPriorityBandwidth(i));
+    }
+    uint32_t cycleBudget = qos->GetCycleBudget() > 0 ? qos->GetCycleBudget() : m_cycleBudget;
+    m_scheduler.Configure(weights, cycleBudget);
+    BuildClassTable();
+
+    for(uint8_t i = 0; i < numPriorities; i++) {
+        UpdateHead(i);
+    }
+}
+
+void PriorityTxQueue::SetClassifier(Classifier classifier) {
+    m_classifier = classifier;
+}
+
+PriorityTxQueue::Classifier PriorityTxQueue::GetClassifier() const {
+    return m_classifier;
+}
+
+uint8_t PriorityTxQueue::Classify(Ptr<const Packet> p) const {
+    uint8_t tos;
+    if(m_classifier == CLASSIFY_DSCP && PeekIpv4Tos(p, tos)) {
+        return m_dscpClassOf[tos >> 2];
+    }
     PriorityTag priorityTag;
     bool found = p->PeekPacketTag(priorityTag);
-    uint8_t priority = found ? priorityTag.GetPriority() : 2; // Default to normal
-    
+    return m_classOf[found ? priorityTag.GetPriority() : 2]; // Default to normal
+}
+
+bool PriorityTxQueue::Enqueue(Ptr<Packet> p) {
+    NS_ASSERT_MSG(m_qosConfig, "SetQosConfig must be called before using the queue");
+    uint8_t priority = Classify(p);
+
     //NS_LOG_DEBUG("Enqueuing packet with priority " << (int)priority << " size: " << p->GetSize());
-    m_queues[priority].push(p);
-    //m_traceEnqueue(p);
+    SubQueue& queue = m_queues[priority];
+    uint32_t size = p->GetSize();
+    if(WouldOverflow(queue.limit, queue.ring.GetSize(), queue.bytes, size)) {
+        NS_LOG_LOGIC("Class full, dropping packet of priority " << (int)priority);
+        DropBeforeEnqueue(p);
+        NotifyClassDrop(p, priority);
+        return false;
+    }
+    Time now = Simulator::Now();
+    if(queue.aqm.GetMode() == ClassAqm::PIE &&
+       queue.aqm.DropOnEnqueue(GetAqmParameters(), now, queue.bytes, m_uniform)) {
+        NS_LOG_LOGIC("PIE dropping packet of priority " << (int)priority);
+        DropBeforeEnqueue(p);
+        NotifyClassDrop(p, priority);
+        return false;
+    }
+
+    // DoEnqueue enforces MaxSize and drops through DropBeforeEnqueue itself
+    Iterator item;
+    if(!DoEnqueue(GetContainer().end(), p, item)) {
+        NS_LOG_LOGIC("Queue full, dropping packet of priority " << (int)priority);
+        NotifyClassDrop(p, priority);
+        return false;
+    }
+    queue.ring.Push(Entry{item, now});
+    queue.bytes += size;
+    if(queue.ring.GetSize() == 1) {
+        m_scheduler.SetHead(priority, size);
+    }
+    if(!m_traceClassEnqueue.IsEmpty()) {
+        m_traceClassEnqueue(p, priority);
+    }
     return true;
 }
 
-Ptr<Packet> PriorityTxQueue::Dequeue() 
+Ptr<Packet> PriorityTxQueue::Dequeue()
 {
     //NS_LOG_FUNCTION(this);
-    
-    // First check if we need to reset counters
-    uint32_t totalSent = 0;
-    for (const auto& counter : m_bytesSentThisCycle) {
-        totalSent += counter.second;
-    }
-    
-    if (totalSent >= m_cycleBudget) {
-        ResetCycleCounters();
-        return nullptr;
-    }
+    NS_ASSERT_MSG(m_qosConfig, "SetQosConfig must be called before using the queue");
 
-    // Try each priority queue in order
-    for (uint8_t prio = 0; prio < m_qosConfig->GetNumPriorities(); ++prio) {
-        auto queueIt = m_queues.find(prio);
-        if (queueIt == m_queues.end() || queueIt->second.empty()) {
-            continue;
+    while(true) {
+        bool express = ExpressEligible();
+        int32_t prio = express ? 0 : m_scheduler.Select();
+        if (prio < 0) {
+            //NS_LOG_LOGIC("No packets available for dequeue within budget");
+            return nullptr;
         }
 
-        uint32_t remainingBudget = m_priorityBudgets[prio] - m_bytesSentThisCycle[prio];
-        if (remainingBudget > 0) {
-            Ptr<Packet> p = queueIt->second.front();
-            if (!p) {
-                queueIt->second.pop();
+        Entry entry = PopEntry(prio);
+        Ptr<Packet> p = DoDequeue(entry.item);
+        SubQueue& queue = m_queues[prio];
+        if(queue.aqm.GetMode() != ClassAqm::NONE) {
+            Time now = Simulator::Now();
+            if(queue.aqm.DropOnDequeue(GetAqmParameters(), now, now - entry.enqueued, queue.bytes)) {
+                // Dropped packets are not charged; the class competes again
+                NS_LOG_LOGIC("CoDel dropping packet of priority " << prio);
+                UpdateHead(prio);
+                DropAfterDequeue(p);
+                NotifyClassDrop(p, prio);
                 continue;
             }
+        }
 
-            uint32_t pktSize = p->GetSize();
-            if (pktSize <= remainingBudget) {
-                queueIt->second.pop();
-                m_bytesSentThisCycle[prio] += pktSize;
-                //NS_LOG_LOGIC("Dequeued packet size " << pktSize << " from queue " << (int)prio);
-                return p;
+        if(express) {
+            // Not charged to the scheduler; the bucket caps the lane instead
+            m_expressTokens = GetExpressTokens() - p->GetSize();
+            m_expressUpdate = Simulator::Now();
+            m_expressPackets++;
+        } else {
+            m_scheduler.Charge(prio, p->GetSize());
+        }
+        UpdateHead(prio);
+        //NS_LOG_LOGIC("Dequeued packet size " << p->GetSize() << " from queue " << prio);
+        if(!m_traceClassDequeue.IsEmpty()) {
+            m_traceClassDequeue(p, prio);
+        }
+        if(m_sojournStats || !m_traceSojourn.IsEmpty()) {
+            Time sojourn = Simulator::Now() - entry.enqueued;
+            if(m_sojournStats) {
+                queue.sojourn.Add(sojourn);
+            }
+            if(!m_traceSojourn.IsEmpty()) {
+                m_traceSojourn(sojourn, prio);
             }
         }
+        return p;
     }
-    
-    //NS_LOG_LOGIC("No packets available for dequeue within budget");
-    return nullptr;
 }
+
 Ptr<Packet> PriorityTxQueue::Remove() {
-    for(uint8_t i = 0; i < m_qosConfig->GetNumPriorities(); i++) {
-        auto queueIt = m_queues.find(i);
-        if(queueIt != m_queues.end() && !queueIt->second.empty()) {
-            Ptr<Packet> p = queueIt->second.front();
-            queueIt->second.pop();
-            return p;
-        }
+    int32_t prio = m_scheduler.GetFirstBacklogged();
+    if(prio < 0) {
+        return nullptr;
     }
-    return nullptr;
+    Entry entry = PopEntry(prio);
+    Ptr<Packet> p = DoRemove(entry.item);
+    UpdateHead(prio);
+    NotifyClassDrop(p, prio);
+    return p;
 }
 
 Ptr<const Packet> PriorityTxQueue::Peek() const {
-    for(uint8_t i = 0; i < m_qosConfig->GetNumPriorities(); i++) {
-        auto queueIt = m_queues.find(i);
-        auto bytesIt = m_bytesSentThisCycle.find(i);
-        
-        if(queueIt != m_queues.end() && !queueIt->second.empty() && 
-           bytesIt != m_bytesSentThisCycle.end() && 
-           bytesIt->second < m_qosConfig->GetPriorityBandwidth(i)) {
-            return queueIt->second.front();
-        }
+    int32_t prio = ExpressEligible() ? 0 : m_scheduler.Select();
+    if(prio < 0) {
+        return nullptr;
     }
-    return nullptr;
+    return *m_queues[prio].ring.Front().item;
 }
 
 Ptr<const Packet> PriorityTxQueue::PeekByPriority(uint8_t priority) const {
-    auto queueIt = m_queues.find(priority);
-    if(queueIt == m_queues.end() || queueIt->second.empty()) {
+    if(priority >= m_queues.size() || m_queues[priority].ring.IsEmpty()) {
         return nullptr;
     }
-    return queueIt->second.front();
+    return *m_queues[priority].ring.Front().item;
+}
+
+void PriorityTxQueue::SetCycleBudget(uint32_t cycleBudget) {
+    m_cycleBudget = cycleBudget;
+    if(m_qosConfig) {
+        ApplyQosConfig();
+    }
+}
+
+void PriorityTxQueue::DoDispose() {
+    if(m_qosConfig) {
+        m_qosConfig->TraceDisconnectWithoutContext(
+            "Changed", MakeCallback(&PriorityTxQueue::QosConfigChanged, this));
+        m_qosConfig = nullptr;
+    }
+    m_queues.clear();
+    m_uniform = nullptr;
+    Queue<Packet>::DoDispose();
+}
+
+void PriorityTxQueue::SetSchedulerMode(PriorityScheduler::Mode mode) {
+    m_scheduler.SetMode(mode);
+}
+
+PriorityScheduler::Mode PriorityTxQueue::GetSchedulerMode() const {
+    return m_scheduler.GetMode();
+}
+
+void PriorityTxQueue::SetQuantum(uint32_t quantum) {
+    m_scheduler.SetQuantum(quantum);
+}
+
+uint32_t PriorityTxQueue::GetQuantum() const {
+    return m_scheduler.GetQuantum();
+}
+
+void PriorityTxQueue::SetBorrowing(bool borrowing) {
+    m_scheduler.SetBorrowing(borrowing);
+}
+
+bool PriorityTxQueue::GetBorrowing() const {
+    return m_scheduler.GetBorrowing();
+}
+
+void PriorityTxQueue::SetDefaultCeiling(uint32_t percent) {
+    m_scheduler.SetDefaultCeiling(percent);
+}
+
+uint32_t PriorityTxQueue::GetDefaultCeiling() const {
+    return m_scheduler.GetDefaultCeiling();
+}
+
+void PriorityTxQueue::SetPriorityCeiling(uint8_t priority, uint32_t percent) {
+    NS_ABORT_MSG_IF(priority >= m_queues.size(),
+                    "Priority " << (int)priority << " not configured; call SetQosConfig first");
+    m_scheduler.SetCeiling(priority, percent);
+}
+
+uint64_t PriorityTxQueue::GetBytesLent(uint8_t priority) const {
+    return priority < m_queues.size() ? m_scheduler.GetBytesLent(priority) : 0;
+}
+
+uint64_t PriorityTxQueue::GetBytesBorrowed(uint8_t priority) const {
+    return priority < m_queues.size() ? m_scheduler.GetBytesBorrowed(priority) : 0;
+}
+
+void PriorityTxQueue::SetLinkRate(DataRate rate) {
+    m_scheduler.SetLinkRate(rate.GetBitRate());
+}
+
+DataRate PriorityTxQueue::GetLinkRate() const {
+    return DataRate(m_scheduler.GetLinkRate());
 }
 
-void PriorityTxQueue::SetCycleBudget(uint32_t cycleBudget) { 
-    m_cycleBudget = cycleBudget; 
+void PriorityTxQueue::SetTokenWindow(Time window) {
+    m_scheduler.SetTokenWindow(window);
 }
 
-void PriorityTxQueue::ResetCycleCounters() {
-    for(auto& counter : m_bytesSentThisCycle) {
-        counter.second = 0;
+Time PriorityTxQueue::GetTokenWindow() const {
+    return m_scheduler.GetTokenWindow();
+}
+
+void PriorityTxQueue::AttachToDevice(Ptr<NetDevice> device) {
+    DataRateValue rate;
+    if(device->GetAttributeFailSafe("DataRate", rate)) {
+        SetLinkRate(rate.Get());
+        NS_LOG_DEBUG("Link rate " << rate.Get() << " read from device " << device->GetIfIndex());
+    } else {
+        NS_ABORT_MSG_IF(m_scheduler.GetLinkRate() == 0,
+                        "Device has no DataRate attribute; set the LinkRate attribute instead");
+    }
+}
+
+Time PriorityTxQueue::GetNextEligibleTime() const {
+    return m_scheduler.GetNextEligibleTime();
+}
+
+void PriorityTxQueue::SetExpressLane(bool enable) {
+    m_expressLane = enable;
+}
+
+bool PriorityTxQueue::GetExpressLane() const {
+    return m_expressLane;
+}
+
+void PriorityTxQueue::SetExpressRate(DataRate rate) {
+    m_expressTokens = GetExpressTokens();
+    m_expressUpdate = Simulator::Now();
+    m_expressRate = rate;
+}
+
+DataRate PriorityTxQueue::GetExpressRate() const {
+    return m_expressRate;
+}
+
+void PriorityTxQueue::SetExpressBurst(uint32_t bytes) {
+    m_expressBurst = bytes;
+    m_expressTokens = bytes;
+    m_expressUpdate = Simulator::Now();
+}
+
+uint32_t PriorityTxQueue::GetExpressBurst() const {
+    return m_expressBurst;
+}
+
+uint64_t PriorityTxQueue::GetExpressNPackets() const {
+    return m_expressPackets;
+}
+
+void PriorityTxQueue::SetPriorityLimit(uint8_t priority, QueueSize limit) {
+    NS_ABORT_MSG_IF(priority >= m_queues.size(),
+                    "Priority " << (int)priority << " not configured; call SetQosConfig first");
+    m_queues[priority].limit = limit;
+}
+
+QueueSize PriorityTxQueue::GetPriorityLimit(uint8_t priority) const {
+    return priority < m_queues.size() ? m_queues[priority].limit : QueueSize();
+}
+
+void PriorityTxQueue::SetDefaultAqm(ClassAqm::Mode mode) {
+    m_defaultAqm = mode;
+}
+
+ClassAqm::Mode PriorityTxQueue::GetDefaultAqm() const {
+    return m_defaultAqm;
+}
+
+void PriorityTxQueue::SetPriorityAqm(uint8_t priority, ClassAqm::Mode mode) {
+    NS_ABORT_MSG_IF(priority >= m_queues.size(),
+                    "Priority " << (int)priority << " not configured; call SetQosConfig first");
+    m_queues[priority].aqm.SetMode(mode);
+}
+
+uint32_t PriorityTxQueue::GetPriorityNPackets(uint8_t priority) const {
+    return priority < m_queues.size() ? m_queues[priority].ring.GetSize() : 0;
+}
+
+uint32_t PriorityTxQueue::GetPriorityNBytes(uint8_t priority) const {
+    return priority < m_queues.size() ? m_queues[priority].bytes : 0;
+}
+
+int64_t PriorityTxQueue::AssignStreams(int64_t stream) {
+    m_uniform->SetStream(stream);
+    return 1;
+}
+
+void PriorityTxQueue::SetSojournStatistics(bool enable) {
+    m_sojournStats = enable;
+}
+
+bool PriorityTxQueue::GetSojournStatistics() const {
+    return m_sojournStats;
+}
+
+const SojournHistogram& PriorityTxQueue::GetSojournHistogram(uint8_t priority) const {
+    NS_ABORT_MSG_IF(priority >= m_queues.size(),
+                    "Priority " << (int)priority << " not configured; call SetQosConfig first");
+    return m_queues[priority].sojourn;
+}
+
+Time PriorityTxQueue::GetSojournPercentile(uint8_t priority, double quantile) const {
+    return priority < m_queues.size() ? m_queues[priority].sojourn.GetPercentile(quantile)
+                                      : Time(0);
+}
+
+void PriorityTxQueue::ResetSojournStatistics() {
+    for(SubQueue& queue : m_queues) {
+        queue.sojourn.Reset();
+    }
+}
+
+bool PriorityTxQueue::WouldOverflow(QueueSize limit, uint32_t packets, uint64_t bytes,
+                                    uint32_t size) {
+    if(limit.GetValue() == 0) {
+        return false;
+    }
+    if(limit.GetUnit() == QueueSizeUnit::PACKETS) {
+        return packets + 1 > limit.GetValue();
+    }
+    return bytes + size > limit.GetValue();
+}
+
+ClassAqm::Parameters PriorityTxQueue::GetAqmParameters() const {
+    ClassAqm::Parameters params;
+    params.codelTarget = m_codelTarget;
+    params.codelInterval = m_codelInterval;
+    params.pieTarget = m_pieTarget;
+    params.pieUpdate = m_pieUpdate;
+    params.pieMaxBurst = MilliSeconds(150);
+    params.mtu = m_aqmMtu;
+    return params;
+}
+
+PriorityTxQueue::Entry PriorityTxQueue::PopEntry(uint8_t prio) {
+    Entry entry = m_queues[prio].ring.Pop();
+    m_queues[prio].bytes -= (*entry.item)->GetSize();
+    return entry;
+}
+
+void PriorityTxQueue::NotifyClassDrop(Ptr<const Packet> p, uint8_t prio) {
+    if(!m_traceClassDrop.IsEmpty()) {
+        m_traceClassDrop(p, prio);
+    }
+}
+
+void PriorityTxQueue::UpdateHead(uint8_t prio) {
+    if(m_queues[prio].ring.IsEmpty()) {
+        m_scheduler.ClearHead(prio);
+    } else {
+        m_scheduler.SetHead(prio, (*m_queues[prio].ring.Front().item)->GetSize());
+    }
+}
+
+bool PriorityTxQueue::ExpressEligible() const {
+    if(!m_expressLane || m_queues.empty() || m_queues[0].ring.IsEmpty()) {
+        return false;
+    }
+    return GetExpressTokens() >= (*m_queues[0].ring.Front().item)->GetSize();
+}
+
+double PriorityTxQueue::GetExpressTokens() const {
+    double refill = m_expressRate.GetBitRate() / 8.0 *
+                    (Simulator::Now() - m_expressUpdate).GetSeconds();
+    return std::min<double>(m_expressBurst, m_expressTokens + refill);
+}
+
+void PriorityTxQueue::BuildClassTable() {
+    // Unknown priorities are served with the lowest configured class
+    uint8_t last = static_cast<uint8_t>(m_queues.size() - 1);
+    for(size_t value = 0; value < m_classOf.size(); value++) {
+        m_classOf[value] = value < m_queues.size() ? static_cast<uint8_t>(value) : last;
+    }
+    for(uint8_t dscp = 0; dscp < m_dscpClassOf.size(); dscp++) {
+        m_dscpClassOf[dscp] = m_classOf[PriorityTag::DscpToPriority(dscp)];
+    }
+}
+
+bool PriorityTxQueue::PeekIpv4Tos(Ptr<const Packet> p, uint8_t& tos) {
+    // Version 4 and a header length (IHL) of at least 5 words, with room
+    // for the 20-byte fixed header, before trusting a TOS byte
+    auto isIpv4 = [](uint8_t versionIhl, uint32_t size) {
+        return (versionIhl >> 4) == 4 && (versionIhl & 0x0f) >= 5 && size >= 20;
+    };
+    // PPP protocol field (0x0021 for IPv4) followed by the IPv4 header
+    uint8_t bytes[4];
+    uint32_t n = p->CopyData(bytes, sizeof(bytes));
+    uint32_t size = p->GetSize();
+    if(n == 4 && bytes[0] == 0x00 && bytes[1] == 0x21 && isIpv4(bytes[2], size - 2)) {
+        tos = bytes[3];
+        return true;
+    }
+    if(n >= 2 && isIpv4(bytes[0], size)) {
+        tos = bytes[1];
+        return true;
     }
+    return false;
 }
 
-} // namespace ns3
\ No newline at end of file
+} // namespace ns3
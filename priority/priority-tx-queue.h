@@ -1,19 +1,85 @@
 #ifndef PRIORITY_TX_QUEUE_H
 #define PRIORITY_TX_QUEUE_H
 
+#include "class-aqm.h"
+#include "ns3/data-rate.h"
 #include "ns3/queue.h"
+#include "ns3/queue-size.h"
+#include "ns3/traced-callback.h"
+#include "priority-scheduler.h"
 #include "qos-config.h"
-#include <map>
-#include <queue>
+#include "ring-buffer.h"
+#include "sojourn-histogram.h"
+#include <array>
+#include <vector>
 
 namespace ns3 {
+
+class NetDevice;
+class UniformRandomVariable;
+
 /**
  * \ingroup uav
  * \brief Priority-based transmission queue for QoS support
  *
- * This queue implements weighted fair queuing based on packet priorities.
- * It maintains separate sub-queues for each priority level and services
- * them according to configured bandwidth weights.
+ * This queue maintains separate sub-queues for each priority level and
+ * services them according to configured bandwidth weights. The
+ * "Scheduler" attribute selects the engine: per-cycle byte budgets with
+ * strict priority (default), deficit round robin or weighted fair
+ * queuing. See PriorityScheduler for details. With the default engine,
+ * idle classes lend their unused budget to backlogged ones up to a
+ * per-class ceiling, and the lent/borrowed bytes are counted per class.
+ * The TokenBucket engine replaces byte cycles by per-class rates of
+ * weight percent of the link rate, read from the device by
+ * AttachToDevice() or given through the "LinkRate" attribute. Device
+ * drivers dequeue right after each enqueue and are never restarted by
+ * their queue, so this queue always runs the engine with token borrowing:
+ * the rates set the shares of a busy link rather than caps. Use
+ * PriorityQueueDisc to enforce the rates.
+ *
+ * Sub-queues are flat ring buffers indexed by priority and sized from
+ * QosConfig::GetNumPriorities(), so no per-packet lookup happens on
+ * the Enqueue/Dequeue path. Up to PriorityScheduler::MAX_CLASSES
+ * priorities are supported.
+ *
+ * The queue honours the "MaxSize" attribute of Queue<Packet> over all
+ * classes, and each class may be given its own limit through
+ * SetPriorityLimit(). A class can additionally run a CoDel or PIE dropper
+ * (the "Aqm" attribute sets the default, SetPriorityAqm() overrides it per
+ * class) that bounds its sojourn time. Packets refused at enqueue are
+ * reported through DropBeforeEnqueue, packets discarded by CoDel at
+ * dequeue through DropAfterDequeue.
+ *
+ * Packets are stored in the Queue<Packet> container through DoEnqueue()
+ * and DoDequeue(), so GetNPackets(), GetNBytes(), the drop statistics and
+ * the Enqueue/Dequeue/Drop trace sources of the base class behave as for
+ * any ns-3 queue. The sub-queue rings hold iterators into that container.
+ * Per-class traces (ClassEnqueue, ClassDequeue, ClassDrop, SojournTime)
+ * add the priority index; their arguments are only built when a sink is
+ * connected.
+ *
+ * The "Classifier" attribute selects where the class comes from: the
+ * PriorityTag (default), or the DSCP of the IPv4 header, which survives
+ * forwarding and shows in pcap traces. DSCP classification reads the TOS
+ * byte behind a PPP header, as queued by PointToPointNetDevice, or at
+ * the start of a bare IPv4 packet, and falls back to the tag for other
+ * packets. A packet only counts as IPv4 with version 4, a header length
+ * of at least five words and at least 20 bytes from the header on. See
+ * PriorityTag::DscpToPriority() for the code points.
+ *
+ * The sojourn time of every sent packet is computed from the arrival
+ * time kept next to it in the sub-queue ring, so no tag or side table is
+ * needed, and counted in a per-class SojournHistogram that reports
+ * percentiles (p50/p95/p99) without storing samples. The
+ * "SojournStatistics" attribute turns the histograms off.
+ *
+ * With "ExpressLane" enabled, class 0 (critical commands) is served ahead
+ * of the scheduler whenever its head packet fits in a token bucket that
+ * fills at "ExpressRate" up to "ExpressBurst" bytes. Express packets are
+ * not charged to the scheduler, so they never wait for a cycle budget or
+ * a DRR round. When the bucket is empty, class 0 falls back to its normal
+ * share, which keeps a flood of critical packets from starving the other
+ * classes.
  */
 class PriorityTxQueue : public Queue<Packet> {
 public:
@@ -21,21 +87,234 @@ public:
      * \brief Get the TypeId for this class
      */
     static TypeId GetTypeId();
+
+    /**
+     * \brief Source of the priority of a packet
+     */
+    enum Classifier {
+        CLASSIFY_TAG,  ///< PriorityTag, priority 2 when untagged
+        CLASSIFY_DSCP  ///< IPv4 DSCP, the PriorityTag for non-IPv4 packets
+    };
+
+    /**
+     * \brief TracedCallback signature for per-class packet events
+     * \param [in] packet The packet
+     * \param [in] priority The priority index of its class
+     */
+    typedef void (*ClassPacketTracedCallback)(Ptr<const Packet> packet, uint8_t priority);
+
+    /**
+     * \brief TracedCallback signature for sojourn time samples
+     * \param [in] sojourn Time the packet spent in the queue
+     * \param [in] priority The priority index of its class
+     */
+    typedef void (*SojournTracedCallback)(Time sojourn, uint8_t priority);
     
     PriorityTxQueue();
     
     /**
      * \brief Set the QoS configuration
      * \param qos The QoS configuration object
+     *
+     * The queue subscribes to the configuration: later weight or cycle
+     * budget changes are applied immediately, keeping queued packets.
      */
     void SetQosConfig(Ptr<QosConfig> qos);
 
     /**
      * \brief Set the cycle budget bytes
-     * \param cycleBudget The size of cycle budget in bytes
+     * \param cycleBudget The size of cycle budget in bytes, used unless
+     *        the QosConfig defines a shared cycle budget
      */
     void SetCycleBudget(uint32_t cycleBudget);
+
+    /**
+     * \brief Set the scheduling engine
+     * \param mode The engine used to pick the next priority class
+     */
+    void SetSchedulerMode(PriorityScheduler::Mode mode);
+    PriorityScheduler::Mode GetSchedulerMode() const;
+
+    /**
+     * \brief Set the DRR quantum
+     * \param quantum Bytes per round of the lowest weighted class
+     */
+    void SetQuantum(uint32_t quantum);
+    uint32_t GetQuantum() const;
+
+    /**
+     * \brief Enable borrowing of idle budget between classes
+     * \param borrowing True to let exhausted classes borrow
+     */
+    void SetBorrowing(bool borrowing);
+    bool GetBorrowing() const;
+
+    /**
+     * \brief Set the ceiling applied to classes created by SetQosConfig
+     * \param percent Percentage of the cycle budget a class may reach
+     */
+    void SetDefaultCeiling(uint32_t percent);
+    uint32_t GetDefaultCeiling() const;
+
+    /**
+     * \brief Set how far a class may borrow beyond its own budget
+     * \param priority The priority level (must be configured)
+     * \param percent Percentage of the cycle budget the class may reach
+     */
+    void SetPriorityCeiling(uint8_t priority, uint32_t percent);
+
+    /**
+     * \brief Get the bytes a priority class has lent to other classes
+     * \param priority The priority level
+     * \return Total lent bytes since the class was configured
+     */
+    uint64_t GetBytesLent(uint8_t priority) const;
+
+    /**
+     * \brief Get the bytes a priority class has borrowed from idle classes
+     * \param priority The priority level
+     * \return Total borrowed bytes since the class was configured
+     */
+    uint64_t GetBytesBorrowed(uint8_t priority) const;
+
+    /**
+     * \brief Set the link rate used by the TokenBucket engine
+     * \param rate The rate of the link the queue feeds
+     */
+    void SetLinkRate(DataRate rate);
+    DataRate GetLinkRate() const;
+
+    /**
+     * \brief Set the token bucket depth as refill time
+     * \param window The burst window of each class
+     */
+    void SetTokenWindow(Time window);
+    Time GetTokenWindow() const;
+
+    /**
+     * \brief Take the link rate from the device the queue is installed on
+     * \param device A device with a "DataRate" attribute, e.g. a
+     *        PointToPointNetDevice. Other devices (Wi-Fi) need the
+     *        "LinkRate" attribute to be set beforehand.
+     */
+    void AttachToDevice(Ptr<NetDevice> device);
+
+    /**
+     * \brief Earliest time a backlogged class is within its token rate
+     * \return Absolute simulation time, Time::Max() if the queue is empty
+     */
+    Time GetNextEligibleTime() const;
+
+    /**
+     * \brief Serve class 0 ahead of the scheduler within a rate cap
+     * \param enable True to enable the express lane
+     */
+    void SetExpressLane(bool enable);
+    bool GetExpressLane() const;
+
+    /**
+     * \brief Set the rate cap of the express lane
+     * \param rate Long-term rate of express packets
+     */
+    void SetExpressRate(DataRate rate);
+    DataRate GetExpressRate() const;
+
+    /**
+     * \brief Set the burst of the express lane
+     * \param bytes Bytes the express lane may send back to back; the
+     *        bucket is refilled to this size
+     */
+    void SetExpressBurst(uint32_t bytes);
+    uint32_t GetExpressBurst() const;
+
+    /**
+     * \brief Get the packets sent through the express lane
+     */
+    uint64_t GetExpressNPackets() const;
+
+    /**
+     * \brief Limit the backlog of one priority class
+     * \param priority The priority level (must be configured)
+     * \param limit Maximum packets or bytes of the class; a zero value
+     *        leaves the class bounded by MaxSize only
+     */
+    void SetPriorityLimit(uint8_t priority, QueueSize limit);
+    QueueSize GetPriorityLimit(uint8_t priority) const;
+
+    /**
+     * \brief Set the dropper applied to classes created by SetQosConfig
+     * \param mode The active queue management of new classes
+     */
+    void SetDefaultAqm(ClassAqm::Mode mode);
+    ClassAqm::Mode GetDefaultAqm() const;
+
+    /**
+     * \brief Select the dropper of one priority class
+     * \param priority The priority level (must be configured)
+     * \param mode The active queue management of the class
+     */
+    void SetPriorityAqm(uint8_t priority, ClassAqm::Mode mode);
+
+    /**
+     * \brief Get the packets queued in one priority class
+     * \param priority The priority level
+     */
+    uint32_t GetPriorityNPackets(uint8_t priority) const;
+
+    /**
+     * \brief Get the bytes queued in one priority class
+     * \param priority The priority level
+     */
+    uint32_t GetPriorityNBytes(uint8_t priority) const;
+
+    /**
+     * \brief Assign a fixed random variable stream to the PIE droppers
+     * \param stream First stream index to use
+     * \return The number of stream indices assigned
+     */
+    int64_t AssignStreams(int64_t stream);
+
+    /**
+     * \brief Enable the per-class sojourn time histograms
+     * \param enable True to count the sojourn time of every sent packet
+     */
+    void SetSojournStatistics(bool enable);
+    bool GetSojournStatistics() const;
+
+    /**
+     * \brief Get the sojourn time histogram of one priority class
+     * \param priority The priority level (must be configured)
+     */
+    const SojournHistogram& GetSojournHistogram(uint8_t priority) const;
+
+    /**
+     * \brief Get a sojourn time percentile of one priority class
+     * \param priority The priority level
+     * \param quantile The fraction of packets at or below the result, e.g. 0.99
+     * \return The percentile, zero if the class has sent nothing
+     */
+    Time GetSojournPercentile(uint8_t priority, double quantile) const;
+
+    /**
+     * \brief Clear the sojourn time histograms of all classes
+     */
+    void ResetSojournStatistics();
     
+    /**
+     * \brief Set where the priority of a packet is read from
+     * \param classifier The classification mode
+     */
+    void SetClassifier(Classifier classifier);
+    Classifier GetClassifier() const;
+
+    /**
+     * \brief Get the class a packet is queued in
+     * \param p The packet
+     * \return Its priority according to the classifier mode, mapped
+     *         through the class lookup table onto a configured priority
+     */
+    uint8_t Classify(Ptr<const Packet> p) const;
+
     // Overridden from Queue<Packet>
     bool Enqueue(Ptr<Packet> p) override;
     Ptr<Packet> Dequeue() override;
@@ -49,17 +328,128 @@ public:
      */
     Ptr<const Packet> PeekByPriority(uint8_t priority) const;
 
+protected:
+    void DoDispose() override;
+
 private:
-    void ResetCycleCounters();
+    /**
+     * \brief Recompute classes and budgets from the QosConfig
+     *
+     * Costs O(classes) unless classes are removed, in which case their
+     * packets move to the lowest remaining class.
+     */
+    void ApplyQosConfig();
+
+    /**
+     * \brief Subscription to the QosConfig "Changed" trace
+     * \param qos The changed configuration
+     */
+    void QosConfigChanged(Ptr<const QosConfig> qos);
+
+    /**
+     * \brief A queued packet and its arrival time
+     */
+    struct Entry {
+        ConstIterator item; ///< Position of the packet in the base container
+        Time enqueued;      ///< Arrival time, for sojourn time and dropping
+    };
+
+    /**
+     * \brief One priority class: packets, occupancy and dropper
+     */
+    struct SubQueue {
+        RingBuffer<Entry> ring; ///< Packets in arrival order
+        uint32_t bytes = 0;     ///< Bytes queued
+        QueueSize limit;        ///< Class limit, zero for none
+        ClassAqm aqm;           ///< Active queue management state
+        SojournHistogram sojourn; ///< Sojourn times of sent packets
+    };
+
+    /**
+     * \brief Check whether one more packet would exceed a limit
+     * \param limit The limit to check, a zero value never overflows
+     * \param packets Packets already queued
+     * \param bytes Bytes already queued
+     * \param size Size of the arriving packet
+     */
+    static bool WouldOverflow(QueueSize limit, uint32_t packets, uint64_t bytes, uint32_t size);
+
+    /**
+     * \brief Collect the dropper tuning from the attributes
+     */
+    ClassAqm::Parameters GetAqmParameters() const;
+
+    /**
+     * \brief Take the head entry of a sub-queue and update its byte count
+     * \param prio The priority index
+     *
+     * The packet stays in the base container until DoDequeue() or
+     * DoRemove() is called on the returned entry.
+     */
+    Entry PopEntry(uint8_t prio);
+
+    /**
+     * \brief Report a dropped packet to the ClassDrop trace
+     * \param p The dropped packet
+     * \param prio The priority index
+     */
+    void NotifyClassDrop(Ptr<const Packet> p, uint8_t prio);
+
+    /**
+     * \brief Report the current head of a sub-queue to the scheduler
+     * \param prio The priority index
+     */
+    void UpdateHead(uint8_t prio);
+
+    /**
+     * \brief Whether the head of class 0 may take the express lane now
+     */
+    bool ExpressEligible() const;
+
+    /**
+     * \brief Express lane tokens, in bytes, at the current time
+     */
+    double GetExpressTokens() const;
+
+    /**
+     * \brief Rebuild the tag value and DSCP to class index lookup tables
+     */
+    void BuildClassTable();
+
+    /**
+     * \brief Read the TOS byte of an IPv4 packet
+     * \param p The packet, optionally starting with a PPP header
+     * \param tos Receives the TOS byte
+     * \return False if the packet does not start with a plausible IPv4 header
+     */
+    static bool PeekIpv4Tos(Ptr<const Packet> p, uint8_t& tos);
     
     Ptr<QosConfig> m_qosConfig; ///< QoS configuration
-    std::map<uint8_t, std::queue<Ptr<Packet>>> m_queues; ///< Priority sub-queues
-    std::map<uint8_t, uint32_t> m_bytesSentThisCycle; ///< Bandwidth tracking
+    std::vector<SubQueue> m_queues; ///< Priority sub-queues
+    std::array<uint8_t, 256> m_classOf; ///< Sub-queue index per tag value
+    std::array<uint8_t, 64> m_dscpClassOf; ///< Sub-queue index per DSCP
+    Classifier m_classifier; ///< Source of the packet priority
     uint32_t m_cycleBudget; // Total bytes per cycle (e.g., 10,000)
-    std::map<uint8_t, uint32_t> m_priorityBudgets; // Byte budgets per priority
+    mutable PriorityScheduler m_scheduler; ///< Class selection; Peek() may advance a DRR round
+    ClassAqm::Mode m_defaultAqm; ///< Dropper of classes created by SetQosConfig
+    Time m_codelTarget;     ///< CoDel target sojourn time
+    Time m_codelInterval;   ///< CoDel interval
+    Time m_pieTarget;       ///< PIE target queueing delay
+    Time m_pieUpdate;       ///< PIE probability update period
+    uint32_t m_aqmMtu;      ///< Backlog in bytes below which the droppers never drop
+    Ptr<UniformRandomVariable> m_uniform; ///< Drop decisions of PIE
+    bool m_sojournStats;    ///< Whether the sojourn histograms are updated
+    bool m_expressLane;     ///< Whether class 0 bypasses the scheduler
+    DataRate m_expressRate; ///< Refill rate of the express bucket
+    uint32_t m_expressBurst; ///< Depth of the express bucket in bytes
+    double m_expressTokens; ///< Express bucket content at m_expressUpdate
+    Time m_expressUpdate;   ///< Time of the last express bucket update
+    uint64_t m_expressPackets; ///< Packets sent through the express lane
 
-    // TracedCallback<Ptr<const Packet>> m_traceEnqueue;
-    // TracedCallback<Ptr<const Packet>> m_traceDequeue;
+    TracedCallback<Ptr<const Packet>, uint8_t> m_traceClassEnqueue; ///< Packet accepted by a class
+    TracedCallback<Ptr<const Packet>, uint8_t> m_traceClassDequeue; ///< Packet sent from a class
+    TracedCallback<Ptr<const Packet>, uint8_t> m_traceClassDrop;    ///< Packet dropped from a class
+    TracedCallback<Time, uint8_t> m_traceSojourn; ///< Sojourn time of each sent packet
 };
 
 } // namespace ns3
@@ -4,25 +4,61 @@ namespace ns3 {
 
 NS_OBJECT_ENSURE_REGISTERED(QosConfig);
 
+QosWeightTable::QosWeightTable(std::vector<uint32_t> weights) : m_weights(std::move(weights)) {}
+
 TypeId QosConfig::GetTypeId() {
     static TypeId tid = TypeId("ns3::QosConfig")
         .SetParent<Object>()
-        .AddConstructor<QosConfig>();
+        .AddConstructor<QosConfig>()
+        .AddTraceSource("Changed", "The weights or the cycle budget changed",
+                        MakeTraceSourceAccessor(&QosConfig::m_changedTrace),
+                        "ns3::QosConfig::ChangedTracedCallback");
     return tid;
 }
 
-QosConfig::QosConfig() : m_weights({50, 30, 15, 5}) {}
+QosConfig::QosConfig() : m_cycleBudget(0) {
+    // All default configs share one table
+    static const Ptr<const QosWeightTable> defaultWeights =
+        Create<QosWeightTable>(std::vector<uint32_t>{50, 30, 15, 5});
+    m_weights = defaultWeights;
+}
 
 void QosConfig::SetQueueWeights(const std::vector<uint32_t>& weights) {
-    m_weights = weights;
+    m_weights = Create<QosWeightTable>(weights);
+    m_changedTrace(this);
+}
+
+void QosConfig::SetQueueWeights(const std::vector<uint32_t>& weights, uint32_t cycleBudget) {
+    m_weights = Create<QosWeightTable>(weights);
+    m_cycleBudget = cycleBudget;
+    m_changedTrace(this);
+}
+
+void QosConfig::SetCycleBudget(uint32_t cycleBudget) {
+    m_cycleBudget = cycleBudget;
+    m_changedTrace(this);
+}
+
+uint32_t QosConfig::GetCycleBudget() const {
+    return m_cycleBudget;
+}
+
+void QosConfig::SetWeightTable(Ptr<const QosWeightTable> table) {
+    NS_ASSERT(table);
+    m_weights = table;
+    m_changedTrace(this);
+}
+
+Ptr<const QosWeightTable> QosConfig::GetWeightTable() const {
+    return m_weights;
 }
 
 uint32_t QosConfig::GetPriorityBandwidth(uint8_t priority) const {
-    return m_weights.at(priority);
+    return m_weights->GetWeight(priority);
 }
 
 uint8_t QosConfig::GetNumPriorities() const {
-    return m_weights.size();
+    return m_weights->GetSize();
 }
 
 } // namespace ns3
\ No newline at end of file
@@ -2,10 +2,35 @@
 #define QOS_CONFIG_H
 
 #include "ns3/object.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/traced-callback.h"
 #include <vector>
 
 namespace ns3 {
 
+/**
+ * \ingroup uav
+ * \brief Immutable vector of class weights
+ *
+ * Tables are reference counted and never modified once built, so any
+ * number of QosConfig objects can point at the same one. Changing the
+ * weights of one config builds a new table for that config only.
+ */
+class QosWeightTable : public SimpleRefCount<QosWeightTable> {
+public:
+    /**
+     * \param weights Weight per priority (sum should equal 100)
+     */
+    explicit QosWeightTable(std::vector<uint32_t> weights);
+
+    const std::vector<uint32_t>& GetWeights() const { return m_weights; }
+    uint32_t GetWeight(uint8_t priority) const { return m_weights.at(priority); }
+    uint8_t GetSize() const { return static_cast<uint8_t>(m_weights.size()); }
+
+private:
+    const std::vector<uint32_t> m_weights; ///< Bandwidth allocation weights
+};
+
 /**
  * \ingroup uav
  * \brief QoS Configuration for priority-based bandwidth allocation
@@ -19,6 +44,11 @@ namespace ns3 {
  * - Priority 1 (High): 30%
  * - Priority 2 (Normal): 15%
  * - Priority 3 (Low): 5%
+ *
+ * A single QosConfig can be shared by any number of queues. Queues
+ * subscribe to its "Changed" trace source and recompute their budgets
+ * whenever the weights or the cycle budget change, so one config object
+ * re-tunes all of them at once.
  */
 class QosConfig : public Object {
 public:
@@ -26,6 +56,12 @@ public:
      * \brief Get the TypeId for this class
      */
     static TypeId GetTypeId();
+
+    /**
+     * \brief TracedCallback signature for configuration changes
+     * \param [in] config The configuration after the change
+     */
+    typedef void (*ChangedTracedCallback)(Ptr<const QosConfig> config);
     
     /**
      * \brief Default constructor with default weights
@@ -39,6 +75,31 @@ public:
      * Example: {50, 30, 15, 5} for 4 priority levels
      */
     void SetQueueWeights(const std::vector<uint32_t>& weights);
+
+    /**
+     * \brief Set the weights and the cycle budget in one change
+     * \param weights Vector of weights (sum should equal 100)
+     * \param cycleBudget Bytes per scheduling cycle, 0 to let each queue
+     *        use its own
+     *
+     * Subscribers are notified once, after both values are updated.
+     */
+    void SetQueueWeights(const std::vector<uint32_t>& weights, uint32_t cycleBudget);
+
+    /**
+     * \brief Set the cycle budget shared by all subscribed queues
+     * \param cycleBudget Bytes per scheduling cycle, 0 to let each queue
+     *        use its own
+     */
+    void SetCycleBudget(uint32_t cycleBudget);
+    uint32_t GetCycleBudget() const;
+
+    /**
+     * \brief Point the config at a shared weight table
+     * \param table The weights; no copy is made
+     */
+    void SetWeightTable(Ptr<const QosWeightTable> table);
+    Ptr<const QosWeightTable> GetWeightTable() const;
     
     /**
      * \brief Get the bandwidth percentage for a priority level
@@ -54,7 +115,9 @@ public:
     uint8_t GetNumPriorities() const;
 
 private:
-    std::vector<uint32_t> m_weights; ///< Bandwidth allocation weights
+    Ptr<const QosWeightTable> m_weights; ///< Bandwidth allocation weights, possibly shared
+    uint32_t m_cycleBudget;              ///< Shared cycle budget, 0 if unset
+    TracedCallback<Ptr<const QosConfig>> m_changedTrace; ///< Notifies subscribed queues
 };
 
 } // namespace ns3
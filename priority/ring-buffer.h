@@ -0,0 +1,107 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include "ns3/assert.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup uav
+ * \brief Contiguous FIFO ring buffer used for the per-priority sub-queues
+ *
+ * Storage is a single power-of-two sized array addressed by index, so
+ * Push/Pop/Front are O(1) and never allocate once the buffer has reached
+ * its working size. When the buffer is full it doubles its capacity and
+ * unrolls the existing items to the start of the new array.
+ */
+template <typename T>
+class RingBuffer
+{
+public:
+    /**
+     * \brief Construct with an initial capacity
+     * \param capacity Initial number of slots (rounded up to a power of two)
+     */
+    explicit RingBuffer(uint32_t capacity = 64)
+        : m_head(0),
+          m_size(0)
+    {
+        uint32_t slots = 1;
+        while (slots < capacity) {
+            slots <<= 1;
+        }
+        m_items.resize(slots);
+        m_mask = slots - 1;
+    }
+
+    bool IsEmpty() const { return m_size == 0; }
+    uint32_t GetSize() const { return m_size; }
+    uint32_t GetCapacity() const { return m_mask + 1; }
+
+    /**
+     * \brief Append an item at the tail
+     * \param item The item to store
+     */
+    void Push(T item)
+    {
+        if (m_size == GetCapacity()) {
+            Grow();
+        }
+        m_items[(m_head + m_size) & m_mask] = std::move(item);
+        m_size++;
+    }
+
+    /**
+     * \brief Access the item at the head
+     * \return Reference to the oldest item
+     */
+    T& Front()
+    {
+        NS_ASSERT(m_size > 0);
+        return m_items[m_head];
+    }
+
+    const T& Front() const
+    {
+        NS_ASSERT(m_size > 0);
+        return m_items[m_head];
+    }
+
+    /**
+     * \brief Remove and return the item at the head
+     * \return The oldest item; its slot is reset so no reference is kept
+     */
+    T Pop()
+    {
+        NS_ASSERT(m_size > 0);
+        T item = std::move(m_items[m_head]);
+        m_items[m_head] = T();
+        m_head = (m_head + 1) & m_mask;
+        m_size--;
+        return item;
+    }
+
+private:
+    void Grow()
+    {
+        std::vector<T> items(GetCapacity() * 2);
+        for (uint32_t i = 0; i < m_size; i++) {
+            items[i] = std::move(m_items[(m_head + i) & m_mask]);
+        }
+        m_items.swap(items);
+        m_head = 0;
+        m_mask = m_items.size() - 1;
+    }
+
+    std::vector<T> m_items; ///< Slot storage, size is a power of two
+    uint32_t m_head;        ///< Index of the oldest item
+    uint32_t m_size;        ///< Number of stored items
+    uint32_t m_mask;        ///< Capacity - 1, used to wrap indices
+};
+
+} // namespace ns3
+
+#endif
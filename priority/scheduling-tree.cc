@@ -0,0 +1,298 @@
+#include "scheduling-tree.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <nlohmann/json.hpp>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("SchedulingTree");
+
+namespace {
+
+using json = nlohmann::json;
+
+/**
+ * Flow group of a ZMQ actor id: "uavN" is N and "gcs" is 0, as in
+ * ZmqReceiverApp.
+ */
+bool ActorGroup(const std::string& id, uint16_t& group) {
+    if(id == "gcs") {
+        group = 0;
+        return true;
+    }
+    if(id.rfind("uav", 0) == 0 && id.size() > 3) {
+        try {
+            unsigned long value = std::stoul(id.substr(3));
+            if(value <= std::numeric_limits<uint16_t>::max()) {
+                group = static_cast<uint16_t>(value);
+                return true;
+            }
+        } catch (const std::exception&) {
+        }
+    }
+    return false;
+}
+
+bool ParseRange(const json& node, const char* key, uint32_t max, uint32_t& value,
+                std::string& error) {
+    if(!node[key].is_number_unsigned() || node[key].get<uint64_t>() > max) {
+        error = std::string("\"") + key + "\" must be an integer from 0 to " + std::to_string(max);
+        return false;
+    }
+    value = node[key].get<uint32_t>();
+    return true;
+}
+
+bool ParsePolicy(const json& node, SchedulingTree::Policy& policy, std::string& error) {
+    std::string name = node.value("policy", std::string("wfq"));
+    if(name == "wfq") {
+        policy = SchedulingTree::WFQ;
+    } else if(name == "strict") {
+        policy = SchedulingTree::STRICT;
+    } else {
+        error = "unknown policy \"" + name + "\"";
+        return false;
+    }
+    return true;
+}
+
+bool ParseChildren(SchedulingTree& tree, uint32_t parent, const json& node, bool hasGroup,
+                   uint16_t group, std::string& error) {
+    if(!node.contains("children") || !node["children"].is_array() || node["children"].empty()) {
+        error = "interior node without children";
+        return false;
+    }
+    for(const json& child : node["children"]) {
+        if(!child.is_object()) {
+            error = "children must be objects";
+            return false;
+        }
+        bool childHasGroup = hasGroup;
+        uint16_t childGroup = group;
+        uint32_t value;
+        if(child.contains("group")) {
+            if(!ParseRange(child, "group", std::numeric_limits<uint16_t>::max(), value, error)) {
+                return false;
+            }
+            childGroup = static_cast<uint16_t>(value);
+            childHasGroup = true;
+        } else if(child.contains("id")) {
+            std::string id = child["id"].get<std::string>();
+            if(!ActorGroup(id, childGroup)) {
+                error = "unknown actor id \"" + id + "\"";
+                return false;
+            }
+            childHasGroup = true;
+        }
+        double weight = child.value("weight", 1.0);
+        if(weight <= 0) {
+            error = "weights must be positive";
+            return false;
+        }
+
+        if(child.contains("priority")) {
+            if(!childHasGroup) {
+                error = "leaf without a flow group";
+                return false;
+            }
+            if(!ParseRange(child, "priority", std::numeric_limits<uint8_t>::max(), value, error)) {
+                return false;
+            }
+            uint32_t leaf = tree.AddLeaf(parent, weight, childGroup, static_cast<uint8_t>(value));
+            if(child.value("default", false)) {
+                tree.SetDefaultLeaf(leaf);
+            }
+        } else {
+            SchedulingTree::Policy policy;
+            if(!ParsePolicy(child, policy, error)) {
+                return false;
+            }
+            uint32_t id = tree.AddNode(parent, weight, policy);
+            if(!ParseChildren(tree, id, child, childHasGroup, childGroup, error)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+SchedulingTree::SchedulingTree() {
+    Clear();
+}
+
+void SchedulingTree::Clear(Policy rootPolicy) {
+    m_nodes.clear();
+    m_nodes.push_back(Node{ROOT, 1.0, rootPolicy, 0, -1, false, 0.0, 0.0, 0.0, 0, {}});
+    m_leafNodes.clear();
+    m_leafGroups.clear();
+    m_leafPriorities.clear();
+    m_leafOf.clear();
+    m_groupDefault.clear();
+    m_defaultLeaf = -1;
+}
+
+uint32_t SchedulingTree::AddChild(uint32_t parent, double weight, Policy policy, int32_t leaf) {
+    NS_ASSERT_MSG(parent < m_nodes.size() && m_nodes[parent].leaf < 0,
+                  "Parent must be an interior node");
+    NS_ASSERT_MSG(weight > 0, "Weights must be positive");
+    uint32_t rank = m_nodes[parent].nChildren++;
+    m_nodes.push_back(Node{parent, weight, policy, rank, leaf, false, 0.0, 0.0, 0.0, 0, {}});
+    return static_cast<uint32_t>(m_nodes.size() - 1);
+}
+
+uint32_t SchedulingTree::AddNode(uint32_t parent, double weight, Policy policy) {
+    return AddChild(parent, weight, policy, -1);
+}
+
+uint32_t SchedulingTree::AddLeaf(uint32_t parent, double weight, uint16_t group,
+                                 uint8_t priority) {
+    uint32_t leaf = static_cast<uint32_t>(m_leafNodes.size());
+    m_leafNodes.push_back(AddChild(parent, weight, WFQ, static_cast<int32_t>(leaf)));
+    m_leafGroups.push_back(group);
+    m_leafPriorities.push_back(priority);
+    if(!m_leafOf.emplace(LeafKey(group, priority), leaf).second) {
+        NS_LOG_WARN("Flow group " << group << " priority " << (int)priority
+                    << " has several leaves, using the first");
+    }
+    auto it = m_groupDefault.find(group);
+    if(it == m_groupDefault.end() || m_leafPriorities[it->second] < priority) {
+        m_groupDefault[group] = leaf;
+    }
+    return leaf;
+}
+
+void SchedulingTree::SetDefaultLeaf(uint32_t leaf) {
+    NS_ASSERT(leaf < m_leafNodes.size());
+    m_defaultLeaf = static_cast<int32_t>(leaf);
+}
+
+uint32_t SchedulingTree::FindLeaf(uint16_t group, uint8_t priority) const {
+    NS_ASSERT_MSG(!m_leafNodes.empty(), "The scheduling tree has no leaves");
+    auto it = m_leafOf.find(LeafKey(group, priority));
+    if(it != m_leafOf.end()) {
+        return it->second;
+    }
+    auto groupIt = m_groupDefault.find(group);
+    if(groupIt != m_groupDefault.end()) {
+        return groupIt->second;
+    }
+    return m_defaultLeaf >= 0 ? static_cast<uint32_t>(m_defaultLeaf)
+                              : static_cast<uint32_t>(m_leafNodes.size() - 1);
+}
+
+uint32_t SchedulingTree::GetNLeaves() const {
+    return static_cast<uint32_t>(m_leafNodes.size());
+}
+
+uint32_t SchedulingTree::GetNNodes() const {
+    return static_cast<uint32_t>(m_nodes.size());
+}
+
+uint16_t SchedulingTree::GetLeafGroup(uint32_t leaf) const {
+    return m_leafGroups.at(leaf);
+}
+
+uint8_t SchedulingTree::GetLeafPriority(uint32_t leaf) const {
+    return m_leafPriorities.at(leaf);
+}
+
+bool SchedulingTree::LoadJson(const std::string& text, std::string& error) {
+    error.clear();
+    try {
+        json root = json::parse(text);
+        Policy policy;
+        if(!root.is_object() || !ParsePolicy(root, policy, error)) {
+            if(error.empty()) {
+                error = "the root must be an object";
+            }
+            Clear();
+            return false;
+        }
+        Clear(policy);
+        bool hasGroup = root.contains("group");
+        uint32_t group = 0;
+        if(hasGroup && !ParseRange(root, "group", std::numeric_limits<uint16_t>::max(), group,
+                                   error)) {
+            Clear();
+            return false;
+        }
+        if(!ParseChildren(*this, ROOT, root, hasGroup, static_cast<uint16_t>(group), error)) {
+            Clear();
+            return false;
+        }
+    } catch (const json::exception& e) {
+        error = e.what();
+        Clear();
+        return false;
+    }
+    NS_LOG_INFO("Loaded scheduling tree with " << GetNLeaves() << " leaves, "
+                << GetNNodes() << " nodes");
+    return true;
+}
+
+void SchedulingTree::Activate(uint32_t leaf) {
+    uint32_t id = m_leafNodes[leaf];
+    NS_ASSERT_MSG(!m_nodes[id].active, "Leaf " << leaf << " is already backlogged");
+    // Stops at the first ancestor that was backlogged already
+    while(id != ROOT && !m_nodes[id].active) {
+        Node& node = m_nodes[id];
+        node.active = true;
+        node.start = std::max(m_nodes[node.parent].vtime, node.finish);
+        Push(node.parent, id);
+        id = node.parent;
+    }
+}
+
+int32_t SchedulingTree::Select() const {
+    if(m_nodes[ROOT].heap.empty()) {
+        return -1;
+    }
+    uint32_t id = ROOT;
+    while(m_nodes[id].leaf < 0) {
+        NS_ASSERT(!m_nodes[id].heap.empty());
+        id = m_nodes[id].heap.front().node;
+    }
+    return m_nodes[id].leaf;
+}
+
+void SchedulingTree::Charge(uint32_t leaf, uint32_t bytes, bool backlogged) {
+    uint32_t id = m_leafNodes[leaf];
+    bool active = backlogged;
+    while(id != ROOT) {
+        Node& node = m_nodes[id];
+        Node& parent = m_nodes[node.parent];
+        NS_ASSERT_MSG(!parent.heap.empty() && parent.heap.front().node == id,
+                      "Charge must follow Select");
+        Pop(node.parent);
+        parent.vtime = node.start;
+        node.finish = node.start + bytes / node.weight;
+        node.active = active;
+        if(active) {
+            node.start = node.finish;
+            Push(node.parent, id);
+        }
+        active = !parent.heap.empty();
+        id = node.parent;
+    }
+}
+
+void SchedulingTree::Push(uint32_t parent, uint32_t child) {
+    Node& node = m_nodes[child];
+    std::vector<HeapEntry>& heap = m_nodes[parent].heap;
+    double key = m_nodes[parent].policy == WFQ ? node.start : static_cast<double>(node.rank);
+    heap.push_back(HeapEntry{key, node.rank, child});
+    std::push_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+}
+
+void SchedulingTree::Pop(uint32_t parent) {
+    std::vector<HeapEntry>& heap = m_nodes[parent].heap;
+    std::pop_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+    heap.pop_back();
+}
+
+} // namespace ns3
@@ -0,0 +1,188 @@
+#ifndef SCHEDULING_TREE_H
+#define SCHEDULING_TREE_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup uav
+ * \brief Hierarchical link sharing scheduler
+ *
+ * A tree of weighted nodes whose leaves are (flow group, priority)
+ * pairs, typically one interior node per UAV with one leaf per traffic
+ * class below it. Each interior node serves its backlogged children
+ * either by weight (WFQ) or in the order they were added (STRICT), so
+ * a WFQ root with one STRICT node per UAV shares the link fairly between
+ * UAVs and by priority within each UAV.
+ *
+ * WFQ nodes use start-time fair queuing: a child is stamped with a
+ * virtual start time when it becomes backlogged and advanced by
+ * bytes / weight each time it is served, and the node serves the child
+ * with the smallest start time. Since the stamp does not depend on the
+ * size of the next packet, a subtree is scheduled without looking into
+ * it. Each node keeps its backlogged children in a binary heap, so
+ * Select() costs O(depth) and Activate()/Charge() O(depth * log(fanout)),
+ * i.e. O(log n) in the number of leaves for a balanced tree.
+ *
+ * Like PriorityScheduler, the tree never touches packets. The owning
+ * queue calls Activate() when a leaf becomes backlogged, Select() to pick
+ * the leaf to serve and Charge() with the bytes sent.
+ */
+class SchedulingTree
+{
+public:
+    /**
+     * \brief How an interior node picks among its children
+     */
+    enum Policy {
+        WFQ,   ///< By weight, start-time fair queuing
+        STRICT ///< First added backlogged child first
+    };
+
+    static constexpr uint32_t ROOT = 0; ///< Node id of the root
+
+    /**
+     * \brief Construct a tree with a WFQ root and no leaves
+     */
+    SchedulingTree();
+
+    /**
+     * \brief Remove all nodes but the root
+     * \param rootPolicy Policy of the root
+     */
+    void Clear(Policy rootPolicy = WFQ);
+
+    /**
+     * \brief Add an interior node
+     * \param parent Node id of an interior node
+     * \param weight Share of the node under a WFQ parent, must be positive
+     * \param policy How the node serves its children
+     * \return The node id
+     */
+    uint32_t AddNode(uint32_t parent, double weight, Policy policy);
+
+    /**
+     * \brief Add a leaf
+     * \param parent Node id of an interior node
+     * \param weight Share of the leaf under a WFQ parent, must be positive
+     * \param group The flow group of the leaf
+     * \param priority The priority of the leaf
+     * \return The leaf index, from 0 in the order leaves are added
+     */
+    uint32_t AddLeaf(uint32_t parent, double weight, uint16_t group, uint8_t priority);
+
+    /**
+     * \brief Set the leaf of packets whose flow group has no leaf
+     * \param leaf The leaf index; the last leaf added by default
+     */
+    void SetDefaultLeaf(uint32_t leaf);
+
+    /**
+     * \brief Find the leaf of a packet
+     * \param group Its flow group
+     * \param priority Its priority
+     * \return The leaf of (group, priority), else the lowest priority leaf
+     *         of the group, else the default leaf
+     */
+    uint32_t FindLeaf(uint16_t group, uint8_t priority) const;
+
+    uint32_t GetNLeaves() const;
+    uint32_t GetNNodes() const;
+    uint16_t GetLeafGroup(uint32_t leaf) const;
+    uint8_t GetLeafPriority(uint32_t leaf) const;
+
+    /**
+     * \brief Build the tree from a JSON description
+     * \param text The JSON text
+     * \param error Set to a description of the problem on failure
+     * \return True if the tree was built; on failure the tree is empty
+     *
+     * The root object and every interior node may carry "policy" ("wfq"
+     * or "strict") and "children"; every node but the root may carry
+     * "weight" (default 1). Objects with a "priority" are leaves. The
+     * flow group of a leaf is its own or its nearest ancestor's "group",
+     * or the actor "id" of the ZMQ position messages ("uavN" is N, "gcs"
+     * is 0). A leaf with "default": true gets unknown flow groups.
+     *
+     * \code
+     * {"policy": "wfq", "children": [
+     *   {"id": "uav1", "weight": 2, "policy": "strict", "children": [
+     *     {"priority": 0}, {"priority": 1}, {"priority": 2}, {"priority": 3}]},
+     *   {"id": "uav2", "policy": "strict", "children": [
+     *     {"priority": 0}, {"priority": 2, "default": true}]}]}
+     * \endcode
+     */
+    bool LoadJson(const std::string& text, std::string& error);
+
+    /**
+     * \brief Mark a leaf backlogged
+     * \param leaf The leaf index; must not be backlogged already
+     */
+    void Activate(uint32_t leaf);
+
+    /**
+     * \brief Pick the leaf to serve
+     * \return The leaf index or -1 if no leaf is backlogged
+     */
+    int32_t Select() const;
+
+    /**
+     * \brief Account for a packet sent from the leaf returned by Select()
+     * \param leaf The leaf index
+     * \param bytes The packet size
+     * \param backlogged Whether the leaf still holds packets
+     */
+    void Charge(uint32_t leaf, uint32_t bytes, bool backlogged);
+
+private:
+    /**
+     * \brief A backlogged child in the heap of its parent
+     */
+    struct HeapEntry {
+        double key;    ///< Virtual start time (WFQ) or rank (STRICT)
+        uint32_t rank; ///< Order among siblings, breaks ties
+        uint32_t node; ///< Child node id
+
+        bool operator>(const HeapEntry& other) const {
+            return key != other.key ? key > other.key : rank > other.rank;
+        }
+    };
+
+    struct Node {
+        uint32_t parent;
+        double weight;
+        Policy policy;
+        uint32_t rank;       ///< Order among siblings
+        int32_t leaf;        ///< Leaf index, -1 for interior nodes
+        bool active;         ///< Whether the node is in its parent's heap
+        double start;        ///< Virtual start time of the next service
+        double finish;       ///< Virtual finish time of the last service
+        double vtime;        ///< Virtual time of an interior node
+        uint32_t nChildren;  ///< Children added so far
+        std::vector<HeapEntry> heap; ///< Backlogged children
+    };
+
+    uint32_t AddChild(uint32_t parent, double weight, Policy policy, int32_t leaf);
+    void Push(uint32_t parent, uint32_t child);
+    void Pop(uint32_t parent);
+
+    static uint32_t LeafKey(uint16_t group, uint8_t priority) {
+        return (static_cast<uint32_t>(group) << 8) | priority;
+    }
+
+    std::vector<Node> m_nodes;          ///< Node 0 is the root
+    std::vector<uint32_t> m_leafNodes;  ///< Node id per leaf
+    std::vector<uint16_t> m_leafGroups; ///< Flow group per leaf
+    std::vector<uint8_t> m_leafPriorities; ///< Priority per leaf
+    std::unordered_map<uint32_t, uint32_t> m_leafOf;  ///< (group, priority) to leaf
+    std::unordered_map<uint16_t, uint32_t> m_groupDefault; ///< Lowest priority leaf per group
+    int32_t m_defaultLeaf; ///< Leaf of unknown groups, -1 for the last leaf
+};
+
+} // namespace ns3
+
+#endif
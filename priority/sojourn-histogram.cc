@@ -0,0 +1,77 @@
+#include "sojourn-histogram.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+SojournHistogram::SojournHistogram() {
+    Reset();
+}
+
+void SojournHistogram::Add(Time sojourn) {
+    int64_t ns = sojourn.GetNanoSeconds();
+    uint64_t value = ns > 0 ? static_cast<uint64_t>(ns) : 0;
+    m_counts[BucketOf(value)]++;
+    m_count++;
+    m_sum += static_cast<double>(value);
+    m_max = std::max(m_max, value);
+}
+
+void SojournHistogram::Reset() {
+    m_counts.fill(0);
+    m_count = 0;
+    m_sum = 0.0;
+    m_max = 0;
+}
+
+uint64_t SojournHistogram::GetCount() const {
+    return m_count;
+}
+
+Time SojournHistogram::GetMean() const {
+    return m_count > 0 ? NanoSeconds(static_cast<int64_t>(m_sum / m_count)) : Time(0);
+}
+
+Time SojournHistogram::GetMax() const {
+    return NanoSeconds(static_cast<int64_t>(m_max));
+}
+
+Time SojournHistogram::GetPercentile(double quantile) const {
+    if(m_count == 0) {
+        return Time(0);
+    }
+    quantile = std::min(1.0, std::max(0.0, quantile));
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(quantile * m_count)));
+
+    uint64_t seen = 0;
+    for(uint32_t bucket = 0; bucket < N_BUCKETS; bucket++) {
+        seen += m_counts[bucket];
+        if(seen >= rank) {
+            return NanoSeconds(static_cast<int64_t>(std::min(UpperBoundOf(bucket), m_max)));
+        }
+    }
+    return GetMax();
+}
+
+uint32_t SojournHistogram::BucketOf(uint64_t value) {
+    // Values below SUB_BUCKETS have one bucket each
+    if(value < SUB_BUCKETS) {
+        return static_cast<uint32_t>(value);
+    }
+    uint32_t exponent = 63 - __builtin_clzll(value);
+    uint32_t shift = exponent - SUB_BUCKET_BITS;
+    uint32_t mantissa = static_cast<uint32_t>(value >> shift) & (SUB_BUCKETS - 1);
+    return (shift + 1) * SUB_BUCKETS + mantissa;
+}
+
+uint64_t SojournHistogram::UpperBoundOf(uint32_t bucket) {
+    if(bucket < SUB_BUCKETS) {
+        return bucket;
+    }
+    uint32_t shift = bucket / SUB_BUCKETS - 1;
+    uint64_t mantissa = bucket % SUB_BUCKETS;
+    uint64_t lower = (SUB_BUCKETS + mantissa) << shift;
+    return lower + ((uint64_t(1) << shift) - 1);
+}
+
+} // namespace ns3
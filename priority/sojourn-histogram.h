@@ -0,0 +1,81 @@
+#ifndef SOJOURN_HISTOGRAM_H
+#define SOJOURN_HISTOGRAM_H
+
+#include "ns3/nstime.h"
+#include <array>
+#include <cstdint>
+
+namespace ns3 {
+
+/**
+ * \ingroup uav
+ * \brief Streaming histogram of sojourn times
+ *
+ * Samples are counted in log-linear buckets: every power of two of
+ * nanoseconds is split into 16 equal buckets, so any percentile is
+ * reported with at most 1/16 relative error while memory stays fixed
+ * (under 8 KiB) whatever the number of samples. No sample is stored.
+ */
+class SojournHistogram
+{
+public:
+    SojournHistogram();
+
+    /**
+     * \brief Count one sample
+     * \param sojourn The sojourn time; negative values count as zero
+     */
+    void Add(Time sojourn);
+
+    /**
+     * \brief Forget all samples
+     */
+    void Reset();
+
+    /**
+     * \brief Get the number of samples
+     */
+    uint64_t GetCount() const;
+
+    /**
+     * \brief Get the mean of the samples, zero if there are none
+     */
+    Time GetMean() const;
+
+    /**
+     * \brief Get the largest sample, zero if there are none
+     */
+    Time GetMax() const;
+
+    /**
+     * \brief Get a percentile of the samples
+     * \param quantile The fraction of samples at or below the result, in [0, 1]
+     * \return The upper bound of the bucket holding the percentile, capped
+     *         at the largest sample; zero if there are no samples
+     */
+    Time GetPercentile(double quantile) const;
+
+private:
+    static constexpr uint32_t SUB_BUCKET_BITS = 4; ///< log2 of buckets per power of two
+    static constexpr uint32_t SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+    static constexpr uint32_t N_BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    /**
+     * \brief Bucket of a value in nanoseconds
+     */
+    static uint32_t BucketOf(uint64_t value);
+
+    /**
+     * \brief Largest value in nanoseconds counted in a bucket
+     */
+    static uint64_t UpperBoundOf(uint32_t bucket);
+
+    std::array<uint64_t, N_BUCKETS> m_counts; ///< Samples per bucket
+    uint64_t m_count; ///< Total samples
+    double m_sum;     ///< Sum of the samples in nanoseconds
+    uint64_t m_max;   ///< Largest sample in nanoseconds
+};
+
+} // namespace ns3
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * \brief Bounded lock-free single-producer/single-consumer queue
+ *
+ * Hands items from one thread to another without locks: the producer
+ * only writes the tail index and the consumer only the head index, each
+ * published with release and read with acquire ordering, so an item is
+ * fully written before the other side can see it. The indices live on
+ * separate cache lines so the two threads do not false-share.
+ *
+ * Exactly one thread may call TryPush() and exactly one TryPop().
+ */
+template <typename T>
+class SpscQueue
+{
+public:
+    /**
+     * \brief Construct with a fixed capacity
+     * \param capacity Number of slots, rounded up to a power of two
+     */
+    explicit SpscQueue(uint32_t capacity = 1024)
+        : m_head(0),
+          m_tail(0)
+    {
+        uint32_t slots = 2;
+        while (slots < capacity)
+        {
+            slots <<= 1;
+        }
+        m_items.resize(slots);
+        m_mask = slots - 1;
+    }
+
+    uint32_t GetCapacity() const { return m_mask + 1; }
+
+    /**
+     * \brief Append an item, from the producer thread
+     * \param item The item, moved from on success
+     * \return False if the queue is full
+     */
+    bool TryPush(T& item)
+    {
+        uint64_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) > m_mask)
+        {
+            return false;
+        }
+        m_items[tail & m_mask] = std::move(item);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * \brief Remove the oldest item, from the consumer thread
+     * \param item Receives the item
+     * \return False if the queue is empty
+     */
+    bool TryPop(T& item)
+    {
+        uint64_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        item = std::move(m_items[head & m_mask]);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    alignas(CACHE_LINE) std::atomic<uint64_t> m_head; ///< Next slot to pop, written by the consumer
+    alignas(CACHE_LINE) std::atomic<uint64_t> m_tail; ///< Next slot to push, written by the producer
+    alignas(CACHE_LINE) std::vector<T> m_items;
+    uint32_t m_mask;
+};
+
+#endif
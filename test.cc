@@ -32,6 +32,7 @@
 #include <iostream>
 #include "uav/uav-telemetry.h"
 #include "uav/uav-command.h"
+#include "uav/uav-command-receiver.h"
 #include "ns3/node-list.h"
 
 using json = nlohmann::json;
@@ -85,18 +86,10 @@ std::string Ipv4ToString(const Ipv4Address &address) {
 }
 
 void PublishZMQMessage(zmq::socket_t* socket, const std::string& topic, const json& message) {
-    // // Send topic as first frame
-    // zmq::message_t topicMsg(topic.begin(), topic.end());
-    // socket.send(topicMsg, zmq::send_flags::sndmore);
-
-    // // Convert JSON to string
-    // std::string messageStr = message.dump();
-
-    // // Send JSON message as second frame
-    // zmq::message_t jsonMsg(messageStr.begin(), messageStr.end());
-    // socket.send(jsonMsg, zmq::send_flags::none);
+    // Topic frame, then the JSON frame, without concatenating them
     std::string messageStr = message.dump();
-    socket->send(zmq::buffer(topic + " " + messageStr), zmq::send_flags::none);
+    socket->send(zmq::buffer(topic), zmq::send_flags::sndmore);
+    socket->send(zmq::buffer(messageStr), zmq::send_flags::none);
 }
 
 
@@ -408,17 +401,18 @@ int main(int argc, char *argv[]) {
     PacketSinkHelper gcsPacketSinkHelper("ns3::UdpSocketFactory", gcsSinkAddress);
 
     uint16_t uavPort = 99;
-    Address uavSinkAddress(InetSocketAddress(uavInterfaces.GetAddress(0), uavPort));
-    PacketSinkHelper uavPacketSinkHelper("ns3::UdpSocketFactory", uavSinkAddress);
     
     // Install sink on AP
     ApplicationContainer gcsSinkApp = gcsPacketSinkHelper.Install(nodes.Get(0));
     gcsSinkApp.Start(Seconds(0.0));
     gcsSinkApp.Stop(Seconds(300.0));
 
-    ApplicationContainer uavSinkApp = uavPacketSinkHelper.Install(nodes.Get(1));
-    uavSinkApp.Start(Seconds(0.0));
-    uavSinkApp.Stop(Seconds(300.0));
+    // Commands are received by a sink that measures their latency
+    Ptr<UavCommandReceiver> commandReceiver = CreateObject<UavCommandReceiver>();
+    commandReceiver->SetAttribute("Port", UintegerValue(uavPort));
+    nodes.Get(1)->AddApplication(commandReceiver);
+    commandReceiver->SetStartTime(Seconds(0.0));
+    commandReceiver->SetStopTime(Seconds(300.0));
 
     TypeId tid = TypeId::LookupByName("ns3::UdpSocketFactory");
     Ptr<Socket> gcsSocket = Socket::CreateSocket(nodes.Get(0), tid);
@@ -465,6 +459,16 @@ int main(int argc, char *argv[]) {
 
     g_outputFile.close();
 
+    // Command latency is the audited SLA
+    for (uint8_t prio : {PRIO_CRITICAL, PRIO_HIGH}) {
+        const SojournHistogram& latency = commandReceiver->GetLatencyHistogram(prio);
+        std::cout << "Command priority " << (int)prio << ": " << latency.GetCount()
+                  << " received, latency"
+                  << " p50 " << latency.GetPercentile(0.50).GetSeconds() * 1000 << " ms"
+                  << " p99 " << latency.GetPercentile(0.99).GetSeconds() * 1000 << " ms"
+                  << " max " << latency.GetMax().GetSeconds() * 1000 << " ms\n";
+    }
+
     Simulator::Destroy();
     return 0;
 }
\ No newline at end of file
@@ -10,6 +10,8 @@
 #include "uav/uav-video-server.h"
 #include "priority/priority-tx-queue.h"
 #include "uav/uav-qos-config.h"
+#include "uav/uav-qos-controller.h"
+#include "uav/uav-qos-helper.h"
 
 using namespace ns3;
 
@@ -50,6 +52,11 @@ void SendCriticalPacket(Ptr<Socket> socket) {
 }
 
 int main(int argc, char *argv[]) {
+    bool adaptiveQos = false;
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("adaptiveQos", "Switch the QoS mode from the measured queue state", adaptiveQos);
+    cmd.Parse(argc, argv);
+
     // Enable logging
     LogComponentEnable("UavPriorityQueueTest", LOG_LEVEL_INFO);
     LogComponentEnable("PriorityTxQueue", LOG_LEVEL_ALL);
@@ -58,6 +65,9 @@ int main(int argc, char *argv[]) {
     LogComponentEnable("UavVideoServer", LOG_LEVEL_ALL);
     LogComponentEnable("VideoStreamClientApplication", LOG_LEVEL_ALL);
     LogComponentEnable("VideoStreamServerApplication", LOG_LEVEL_ALL);
+    if (adaptiveQos) {
+        LogComponentEnable("UavQosController", LOG_LEVEL_INFO); // Mode transitions
+    }
 
     // Create nodes
     NodeContainer nodes;
@@ -85,21 +95,21 @@ int main(int argc, char *argv[]) {
     address.SetBase("10.1.1.0", "255.255.255.0");
     Ipv4InterfaceContainer interfaces = address.Assign(devices);
 
-    // Create and configure QoS
-    Ptr<UavQosConfig> qosConfig = CreateObject<UavQosConfig>();
-    qosConfig->SetOperationMode(UavQosConfig::HIGH_QUALITY_VIDEO);
-
-    // Ptr<QosConfig> qosConfig = CreateObject<QosConfig>();
-    // qosConfig->SetQueueWeights({50, 30, 15, 5});
-
-    // Create and configure priority queue
-    Ptr<PriorityTxQueue> priorityQueue = CreateObject<PriorityTxQueue>();
-    priorityQueue->SetQosConfig(qosConfig);
-    priorityQueue->SetCycleBudget(12500000);
-    
-    // Replace the default queue with our priority queue
-    Ptr<PointToPointNetDevice> p2pDevice = DynamicCast<PointToPointNetDevice>(devices.Get(1));
-    p2pDevice->SetQueue(priorityQueue);
+    // Create and configure QoS, and install the priority queue in place
+    // of the default queue
+    UavQosHelper qosHelper;
+    qosHelper.SetOperationMode(UavQosConfig::HIGH_QUALITY_VIDEO);
+    qosHelper.SetCycleBudget(12500000);
+    Ptr<PriorityTxQueue> priorityQueue = qosHelper.Install(devices.Get(1));
+    Ptr<UavQosConfig> qosConfig = qosHelper.GetQosConfig(nodes.Get(1));
+
+    Ptr<UavQosController> qosController;
+    if (adaptiveQos) {
+        qosController = CreateObject<UavQosController>();
+        qosController->SetQosConfig(qosConfig);
+        qosController->AttachQueue(priorityQueue);
+        qosController->Start();
+    }
 
     // // Create UDP sockets for critical communication test
     // TypeId tid = TypeId::LookupByName("ns3::UdpSocketFactory");
@@ -165,6 +175,15 @@ int main(int argc, char *argv[]) {
     Simulator::Stop(Seconds(40.0));
     Simulator::Run();
 
+    // Queueing delay per traffic class
+    for (uint8_t prio = 0; prio < qosConfig->GetNumPriorities(); prio++) {
+        const SojournHistogram& sojourn = priorityQueue->GetSojournHistogram(prio);
+        std::cout << "Priority " << (int)prio << ": " << sojourn.GetCount() << " packets, sojourn"
+                  << " p50 " << sojourn.GetPercentile(0.50).GetSeconds() * 1000 << " ms"
+                  << " p95 " << sojourn.GetPercentile(0.95).GetSeconds() * 1000 << " ms"
+                  << " p99 " << sojourn.GetPercentile(0.99).GetSeconds() * 1000 << " ms\n";
+    }
+
     // Print statistics
     // std::cout << "\nSimulation Results:\n";
     // std::cout << "Total packets sent: " << totalPacketsSent << "\n";
@@ -4,6 +4,8 @@
 #include "ns3/mobility-module.h"
 #include "ns3/internet-module.h"
 #include "ns3/applications-module.h"
+#include "ns3/traffic-control-module.h"
+#include "priority/priority-queue-disc.h"
 
 using namespace ns3;
 
@@ -107,6 +109,14 @@ int main(int argc, char *argv[])
     // Install 5 GHz network (Data - AC_BK)
     InstallWifiNetwork(apNode5, staNode5, devices5, 5.0, "UAV_Data", AC_BK);
 
+    // Priority scheduling above the MAC; installed before addressing so
+    // that no default root queue disc is created
+    TrafficControlHelper tch;
+    tch.SetRootQueueDisc("ns3::PriorityQueueDisc",
+                         "MapToAccessCategory", BooleanValue(true));
+    tch.Install(devices24);
+    tch.Install(devices5);
+
     // IP addressing
     Ipv4AddressHelper ipv4;
     ipv4.SetBase("192.168.1.0", "255.255.255.0");
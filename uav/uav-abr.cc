@@ -0,0 +1,224 @@
+#include "uav-abr.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("UavAbr");
+NS_OBJECT_ENSURE_REGISTERED(UavAbrAlgorithm);
+NS_OBJECT_ENSURE_REGISTERED(UavBbaAbr);
+NS_OBJECT_ENSURE_REGISTERED(UavThroughputAbr);
+NS_OBJECT_ENSURE_REGISTERED(UavMpcAbr);
+
+TypeId UavAbrAlgorithm::GetTypeId() {
+    static TypeId tid = TypeId("ns3::UavAbrAlgorithm")
+        .SetParent<Object>()
+        .SetGroupName("Uav")
+        .AddAttribute("Alpha", "EWMA gain of the throughput and frame size estimates",
+                      DoubleValue(0.2),
+                      MakeDoubleAccessor(&UavAbrAlgorithm::m_alpha),
+                      MakeDoubleChecker<double>(0.0, 1.0));
+    return tid;
+}
+
+UavAbrAlgorithm::UavAbrAlgorithm()
+    : m_alpha(0.2),
+      m_throughput(0),
+      m_lastSample(0) {}
+
+UavAbrAlgorithm::~UavAbrAlgorithm() {}
+
+void UavAbrAlgorithm::ReportFrame(uint16_t level, uint32_t bytes, uint32_t firstBytes, Time spread) {
+    if(level == 0) {
+        return;
+    }
+    if(m_frameBytes.size() < level) {
+        m_frameBytes.resize(level, 0);
+    }
+    double& size = m_frameBytes[level - 1];
+    size = size > 0 ? (1 - m_alpha) * size + m_alpha * bytes : bytes;
+
+    // Single fragment frames have no spread to measure. The first fragment
+    // was already in when the spread started, so it is not counted
+    if(spread.IsStrictlyPositive() && bytes > firstBytes) {
+        m_lastSample = double(bytes - firstBytes) * 8 / spread.GetSeconds();
+        m_throughput = m_throughput > 0 ? (1 - m_alpha) * m_throughput + m_alpha * m_lastSample
+                                        : m_lastSample;
+    }
+}
+
+double UavAbrAlgorithm::GetThroughput() const {
+    return m_throughput;
+}
+
+double UavAbrAlgorithm::GetLastSample() const {
+    return m_lastSample;
+}
+
+double UavAbrAlgorithm::GetBitrate(uint16_t level, double frameRate) const {
+    if(level == 0) {
+        return 0;
+    }
+    // Nearest level with a measured frame size, preferring lower ones
+    for(uint32_t distance = 0; distance < std::max<size_t>(level, m_frameBytes.size()); distance++) {
+        for(int64_t known : {int64_t(level) - int64_t(distance), int64_t(level) + int64_t(distance)}) {
+            if(known >= 1 && known <= int64_t(m_frameBytes.size()) && m_frameBytes[known - 1] > 0) {
+                return m_frameBytes[known - 1] * 8 * frameRate * level / known;
+            }
+        }
+    }
+    return 0;
+}
+
+TypeId UavBbaAbr::GetTypeId() {
+    static TypeId tid = TypeId("ns3::UavBbaAbr")
+        .SetParent<UavAbrAlgorithm>()
+        .SetGroupName("Uav")
+        .AddConstructor<UavBbaAbr>()
+        .AddAttribute("Reservoir", "Buffer below which the lowest level is requested",
+                      TimeValue(Seconds(1)),
+                      MakeTimeAccessor(&UavBbaAbr::m_reservoir),
+                      MakeTimeChecker())
+        .AddAttribute("Cushion", "Buffer range over which the level rises to the highest",
+                      TimeValue(Seconds(4)),
+                      MakeTimeAccessor(&UavBbaAbr::m_cushion),
+                      MakeTimeChecker());
+    return tid;
+}
+
+UavBbaAbr::UavBbaAbr()
+    : m_reservoir(Seconds(1)),
+      m_cushion(Seconds(4)) {}
+
+uint16_t UavBbaAbr::SelectLevel(const UavAbrState& state) {
+    if(state.buffer <= m_reservoir) {
+        return 1;
+    }
+    if(state.buffer >= m_reservoir + m_cushion) {
+        return state.maxLevel;
+    }
+    double minRate = GetBitrate(1, state.frameRate);
+    double maxRate = GetBitrate(state.maxLevel, state.frameRate);
+    if(maxRate <= 0) {
+        return state.level;
+    }
+    double target = minRate + (maxRate - minRate) * (state.buffer - m_reservoir).GetSeconds()
+                    / m_cushion.GetSeconds();
+
+    double up = state.level < state.maxLevel ? GetBitrate(state.level + 1, state.frameRate)
+                                             : std::numeric_limits<double>::infinity();
+    double down = state.level > 1 ? GetBitrate(state.level - 1, state.frameRate) : 0;
+    uint16_t level = state.level;
+    if(target >= up) {
+        // Highest level below the target rate
+        while(level < state.maxLevel && GetBitrate(level + 1, state.frameRate) < target) {
+            level++;
+        }
+    } else if(target <= down) {
+        // Lowest level above the target rate
+        while(level > 1 && GetBitrate(level - 1, state.frameRate) > target) {
+            level--;
+        }
+    }
+    return level;
+}
+
+TypeId UavThroughputAbr::GetTypeId() {
+    static TypeId tid = TypeId("ns3::UavThroughputAbr")
+        .SetParent<UavAbrAlgorithm>()
+        .SetGroupName("Uav")
+        .AddConstructor<UavThroughputAbr>()
+        .AddAttribute("SafetyFactor", "Fraction of the smoothed throughput the bitrate may use",
+                      DoubleValue(0.8),
+                      MakeDoubleAccessor(&UavThroughputAbr::m_safety),
+                      MakeDoubleChecker<double>(0.0, 1.0));
+    return tid;
+}
+
+UavThroughputAbr::UavThroughputAbr()
+    : m_safety(0.8) {}
+
+uint16_t UavThroughputAbr::SelectLevel(const UavAbrState& state) {
+    double budget = GetThroughput() * m_safety;
+    if(budget <= 0) {
+        return state.level;
+    }
+    uint16_t level = 1;
+    while(level < state.maxLevel && GetBitrate(level + 1, state.frameRate) <= budget) {
+        level++;
+    }
+    return level;
+}
+
+TypeId UavMpcAbr::GetTypeId() {
+    static TypeId tid = TypeId("ns3::UavMpcAbr")
+        .SetParent<UavAbrAlgorithm>()
+        .SetGroupName("Uav")
+        .AddConstructor<UavMpcAbr>()
+        .AddAttribute("Horizon", "One-second steps simulated ahead",
+                      UintegerValue(5),
+                      MakeUintegerAccessor(&UavMpcAbr::m_horizon),
+                      MakeUintegerChecker<uint32_t>(1))
+        .AddAttribute("SwitchPenalty", "Score lost per Mbit/s of level switch",
+                      DoubleValue(1.0),
+                      MakeDoubleAccessor(&UavMpcAbr::m_switchPenalty),
+                      MakeDoubleChecker<double>(0.0))
+        .AddAttribute("StallPenalty", "Score lost per second of predicted stall",
+                      DoubleValue(4.3),
+                      MakeDoubleAccessor(&UavMpcAbr::m_stallPenalty),
+                      MakeDoubleChecker<double>(0.0));
+    return tid;
+}
+
+UavMpcAbr::UavMpcAbr()
+    : m_horizon(5),
+      m_switchPenalty(1.0),
+      m_stallPenalty(4.3),
+      m_prediction(0) {}
+
+uint16_t UavMpcAbr::SelectLevel(const UavAbrState& state) {
+    double sample = GetLastSample();
+    if(m_prediction > 0 && sample > 0) {
+        m_errors.push_back(std::abs(m_prediction - sample) / sample);
+        if(m_errors.size() > 5) {
+            m_errors.pop_front();
+        }
+    }
+    m_prediction = GetThroughput();
+    if(m_prediction <= 0) {
+        return state.level;
+    }
+    double maxError = m_errors.empty() ? 0 : *std::max_element(m_errors.begin(), m_errors.end());
+    double throughput = m_prediction / (1 + maxError);
+
+    double current = GetBitrate(state.level, state.frameRate);
+    uint16_t best = state.level;
+    double bestScore = -std::numeric_limits<double>::infinity();
+    for(uint16_t level = 1; level <= state.maxLevel; level++) {
+        double rate = GetBitrate(level, state.frameRate);
+        double buffer = state.buffer.GetSeconds();
+        double stall = 0;
+        for(uint32_t step = 0; step < m_horizon; step++) {
+            // Fetching one second of video at this level
+            buffer -= rate / throughput;
+            if(buffer < 0) {
+                stall -= buffer;
+                buffer = 0;
+            }
+            buffer += 1;
+        }
+        double score = m_horizon * rate / 1e6 - m_switchPenalty * std::abs(rate - current) / 1e6
+                       - m_stallPenalty * stall;
+        if(score > bestScore) {
+            bestScore = score;
+            best = level;
+        }
+    }
+    return best;
+}
+
+} // namespace ns3
@@ -0,0 +1,167 @@
+#ifndef UAV_ABR_H
+#define UAV_ABR_H
+
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup uav
+ * \brief Playback state an adaptive bitrate decision is based on
+ */
+struct UavAbrState {
+    uint16_t level = 1;     ///< Level currently requested
+    uint16_t maxLevel = 1;  ///< Highest level, levels start at 1
+    Time buffer;            ///< Playable video buffered at the client
+    double frameRate = 25;  ///< Frames per second
+};
+
+/**
+ * \ingroup uav
+ * \brief Base class of the video quality adaptation strategies
+ *
+ * The client reports every complete frame through ReportFrame() and asks
+ * SelectLevel() for the level to request. The base class keeps the
+ * estimates all strategies need:
+ *
+ * - the throughput, an EWMA of the frames' burst rate. The server sends
+ *   the fragments of a frame back to back, so the bytes after the first
+ *   fragment over the spread from first to last fragment measure the path
+ *   rather than the video rate.
+ * - the bitrate of each level, learned as an EWMA of its frame size. The
+ *   client does not know the server's ladder; levels not seen yet are
+ *   extrapolated proportionally from the nearest level that was.
+ */
+class UavAbrAlgorithm : public Object
+{
+public:
+    static TypeId GetTypeId();
+
+    UavAbrAlgorithm();
+    ~UavAbrAlgorithm() override;
+
+    /**
+     * \brief Account a complete frame
+     * \param level The level the frame was requested at
+     * \param bytes Bytes of the frame
+     * \param firstBytes Bytes of its first fragment, which arrived at the
+     *        start of the spread and so is not part of the rate sample
+     * \param spread Time from its first to its last fragment
+     */
+    void ReportFrame(uint16_t level, uint32_t bytes, uint32_t firstBytes, Time spread);
+
+    /**
+     * \brief Get the smoothed throughput
+     * \return Bits per second, 0 before the first sample
+     */
+    double GetThroughput() const;
+
+    /**
+     * \brief Get the most recent throughput sample
+     * \return Bits per second, 0 before the first sample
+     */
+    double GetLastSample() const;
+
+    /**
+     * \brief Get the estimated bitrate of a level
+     * \param level The level, from 1
+     * \param frameRate Frames per second
+     * \return Bits per second, 0 before the first frame
+     */
+    double GetBitrate(uint16_t level, double frameRate) const;
+
+    /**
+     * \brief Choose the level to request
+     * \param state The playback state
+     * \return A level between 1 and state.maxLevel
+     */
+    virtual uint16_t SelectLevel(const UavAbrState& state) = 0;
+
+private:
+    double m_alpha;                  ///< EWMA gain of the estimates
+    double m_throughput;             ///< Smoothed burst rate, bit/s
+    double m_lastSample;             ///< Last burst rate, bit/s
+    std::vector<double> m_frameBytes; ///< Mean frame size per level, 0 if unseen
+};
+
+/**
+ * \ingroup uav
+ * \brief Buffer-based adaptation (BBA-0)
+ *
+ * Below the reservoir the lowest level is requested and above reservoir
+ * plus cushion the highest. In between the buffer maps linearly to a rate
+ * between the lowest and highest bitrate; the level only changes once
+ * that rate passes the bitrate of a neighbouring level, which keeps the
+ * choice stable while the buffer moves within one step.
+ */
+class UavBbaAbr : public UavAbrAlgorithm
+{
+public:
+    static TypeId GetTypeId();
+
+    UavBbaAbr();
+
+    uint16_t SelectLevel(const UavAbrState& state) override;
+
+private:
+    Time m_reservoir;  ///< Buffer kept at the lowest level
+    Time m_cushion;    ///< Buffer range mapped onto the ladder
+};
+
+/**
+ * \ingroup uav
+ * \brief Throughput-based adaptation
+ *
+ * Requests the highest level whose bitrate fits in the smoothed
+ * throughput scaled by a safety factor.
+ */
+class UavThroughputAbr : public UavAbrAlgorithm
+{
+public:
+    static TypeId GetTypeId();
+
+    UavThroughputAbr();
+
+    uint16_t SelectLevel(const UavAbrState& state) override;
+
+private:
+    double m_safety;  ///< Fraction of the throughput that may be used
+};
+
+/**
+ * \ingroup uav
+ * \brief Hybrid model predictive adaptation (MPC-lite)
+ *
+ * For each level the buffer is simulated over a horizon of one-second
+ * steps at the predicted throughput, and the level with the best QoE
+ * score is requested: bitrate in Mbit/s per step, minus a penalty per
+ * Mbit/s of switching away from the current level and per second of
+ * predicted stall. As in RobustMPC the throughput prediction is divided
+ * by one plus the largest relative prediction error of the last five
+ * samples. Holding one level over the horizon keeps the search linear in
+ * the number of levels.
+ */
+class UavMpcAbr : public UavAbrAlgorithm
+{
+public:
+    static TypeId GetTypeId();
+
+    UavMpcAbr();
+
+    uint16_t SelectLevel(const UavAbrState& state) override;
+
+private:
+    uint32_t m_horizon;          ///< Steps looked ahead
+    double m_switchPenalty;      ///< Score lost per Mbit/s of switch
+    double m_stallPenalty;       ///< Score lost per second of stall
+    double m_prediction;         ///< Throughput predicted at the last call
+    std::deque<double> m_errors; ///< Recent relative prediction errors
+};
+
+} // namespace ns3
+
+#endif
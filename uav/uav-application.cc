@@ -1,5 +1,6 @@
 #include "uav-application.h"
 #include "../priority/priority-tx-queue.h"
+#include "ns3/boolean.h"
 #include "ns3/log.h"
 
 namespace ns3 {
@@ -12,10 +13,21 @@ UavApplication::GetTypeId()
 {
     static TypeId tid = TypeId("ns3::UavApplication")
         .SetParent<Application>()
-        .AddConstructor<UavApplication>();
+        .AddConstructor<UavApplication>()
+        .AddAttribute("UseIpTos",
+                      "Also carry the priority in the DSCP of the IP header, set on "
+                      "the socket; the PriorityTag is still added for the flow group",
+                      BooleanValue(false),
+                      MakeBooleanAccessor(&UavApplication::m_useIpTos),
+                      MakeBooleanChecker());
     return tid;
 }
 
+UavApplication::UavApplication()
+    : m_useIpTos(false)
+{
+}
+
 void
 UavApplication::DoInitialize()
 {
@@ -40,7 +52,17 @@ UavApplication::SendWithPriority(Ptr<Packet> packet, Priority priority) {
         return;
     }
 
-    PriorityTag priorityTag(static_cast<uint8_t>(priority));
+    if (m_useIpTos) {
+        uint8_t tos = PriorityTag::PriorityToDscp(static_cast<uint8_t>(priority)) << 2;
+        if (m_socket->GetIpTos() != tos) {
+            m_socket->SetIpTos(tos);
+        }
+    }
+    // The node id groups the flows of one UAV on shared links. The DSCP has
+    // no room for it, so the tag is added in TOS mode too; both carry the
+    // same priority
+    PriorityTag priorityTag(static_cast<uint8_t>(priority),
+                            static_cast<uint16_t>(GetNode()->GetId()));
     packet->AddPacketTag(priorityTag);
     NS_LOG_DEBUG("Sending packet with priority " << (int)priority << " size: " << packet->GetSize());
     
@@ -19,13 +19,28 @@ class UavApplication : public Application {
 public:
     
     static TypeId GetTypeId();
+
+    UavApplication();
     
     void SetSocket(Ptr<Socket> socket);
+
+    /**
+     * \brief Send a packet in a priority class
+     * \param packet The packet to send
+     * \param priority Its class
+     *
+     * The class and the node id, as flow group, are carried in a
+     * PriorityTag. With "UseIpTos" the class is also set in the DSCP of
+     * the IPv4 header (see PriorityTag::PriorityToDscp()), so DSCP
+     * classification keeps working after forwarding while
+     * HierarchicalTxQueue still tells the UAVs apart.
+     */
     void SendWithPriority(Ptr<Packet> packet, Priority priority);
 
 protected:
     virtual void DoInitialize();
     Ptr<Socket> m_socket;
+    bool m_useIpTos; ///< Also mark the class in the IP TOS byte
 };
 
 } // namespace ns3
@@ -0,0 +1,102 @@
+#include "uav-command-receiver.h"
+#include "../priority/priority-tag.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/log.h"
+#include "ns3/seq-ts-header.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("UavCommandReceiver");
+NS_OBJECT_ENSURE_REGISTERED(UavCommandReceiver);
+
+TypeId UavCommandReceiver::GetTypeId() {
+    static TypeId tid = TypeId("ns3::UavCommandReceiver")
+        .SetParent<Application>()
+        .AddConstructor<UavCommandReceiver>()
+        .AddAttribute("Port", "UDP port commands are received on",
+                     UintegerValue(99),
+                     MakeUintegerAccessor(&UavCommandReceiver::m_port),
+                     MakeUintegerChecker<uint16_t>())
+        .AddTraceSource("CommandLatency", "A command was received",
+                     MakeTraceSourceAccessor(&UavCommandReceiver::m_commandLatencyTrace),
+                     "ns3::UavCommandReceiver::CommandLatencyTracedCallback");
+    return tid;
+}
+
+UavCommandReceiver::UavCommandReceiver()
+    : m_port(99),
+      m_latency(4) {}
+
+uint64_t UavCommandReceiver::GetReceived(uint8_t priority) const {
+    return priority < m_latency.size() ? m_latency[priority].GetCount() : 0;
+}
+
+const SojournHistogram& UavCommandReceiver::GetLatencyHistogram(uint8_t priority) const {
+    static const SojournHistogram empty;
+    return priority < m_latency.size() ? m_latency[priority] : empty;
+}
+
+Time UavCommandReceiver::GetLatencyPercentile(uint8_t priority, double quantile) const {
+    return GetLatencyHistogram(priority).GetPercentile(quantile);
+}
+
+void UavCommandReceiver::DoDispose() {
+    m_socket = nullptr;
+    Application::DoDispose();
+}
+
+void UavCommandReceiver::StartApplication() {
+    if(!m_socket) {
+        m_socket = Socket::CreateSocket(GetNode(), TypeId::LookupByName("ns3::UdpSocketFactory"));
+        if(m_socket->Bind(InetSocketAddress(Ipv4Address::GetAny(), m_port)) == -1) {
+            NS_FATAL_ERROR("Failed to bind command socket to port " << m_port);
+        }
+        m_socket->SetIpRecvTos(true);
+    }
+    m_socket->SetRecvCallback(MakeCallback(&UavCommandReceiver::HandleRead, this));
+}
+
+void UavCommandReceiver::StopApplication() {
+    if(m_socket) {
+        m_socket->Close();
+        m_socket->SetRecvCallback(MakeNullCallback<void, Ptr<Socket>>());
+        m_socket = nullptr;
+    }
+}
+
+void UavCommandReceiver::HandleRead(Ptr<Socket> socket) {
+    Ptr<Packet> packet;
+    Address from;
+    while((packet = socket->RecvFrom(from))) {
+        SeqTsHeader header;
+        if(packet->GetSize() < header.GetSerializedSize()) {
+            NS_LOG_WARN("Packet too short for a command header");
+            continue;
+        }
+        packet->RemoveHeader(header);
+        Time latency = Simulator::Now() - header.GetTs();
+
+        // Senders in TOS mode also add the tag, so the DSCP goes first. The
+        // socket tags every packet with its TOS; 0 means no marking
+        uint8_t priority = 2; // Default to normal
+        PriorityTag priorityTag;
+        SocketIpTosTag tosTag;
+        if(packet->PeekPacketTag(tosTag) && tosTag.GetTos() != 0) {
+            priority = PriorityTag::DscpToPriority(tosTag.GetTos() >> 2);
+        } else if(packet->PeekPacketTag(priorityTag)) {
+            priority = priorityTag.GetPriority();
+        }
+
+        if(priority >= m_latency.size()) {
+            m_latency.resize(priority + 1);
+        }
+        m_latency[priority].Add(latency);
+        NS_LOG_INFO("Command " << header.GetSeq() << " priority " << (int)priority
+                    << " latency " << latency.As(Time::MS));
+        m_commandLatencyTrace(latency, priority);
+    }
+}
+
+} // namespace ns3
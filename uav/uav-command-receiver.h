@@ -0,0 +1,74 @@
+#ifndef UAV_COMMAND_RECEIVER_H
+#define UAV_COMMAND_RECEIVER_H
+
+#include "../priority/sojourn-histogram.h"
+#include "ns3/application.h"
+#include "ns3/socket.h"
+#include "ns3/traced-callback.h"
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup uav
+ * \brief UAV side sink of UavCommand packets that measures command latency
+ *
+ * The end-to-end latency of every command is the receive time minus the
+ * send time in its SeqTsHeader. It is counted per priority in a
+ * SojournHistogram, read through GetLatencyPercentile(), and reported by
+ * the "CommandLatency" trace. The priority is read from the DSCP of the
+ * received IPv4 header when the sender marked one ("UseIpTos"), which is
+ * what the network classified, and from the PriorityTag otherwise. A
+ * zero TOS counts as unmarked; the tag of such a packet is then used.
+ */
+class UavCommandReceiver : public Application
+{
+public:
+    /**
+     * \brief TracedCallback signature for received commands
+     * \param [in] latency Time from send to receive
+     * \param [in] priority Priority of the command
+     */
+    typedef void (*CommandLatencyTracedCallback)(Time latency, uint8_t priority);
+
+    static TypeId GetTypeId();
+    UavCommandReceiver();
+
+    /**
+     * \brief Get the number of commands received with a priority
+     * \param priority The priority level
+     */
+    uint64_t GetReceived(uint8_t priority) const;
+
+    /**
+     * \brief Get the latency histogram of one priority
+     * \param priority The priority level
+     */
+    const SojournHistogram& GetLatencyHistogram(uint8_t priority) const;
+
+    /**
+     * \brief Get a latency percentile of one priority
+     * \param priority The priority level
+     * \param quantile The fraction of commands at or below the result, e.g. 0.99
+     * \return The percentile, zero if nothing was received
+     */
+    Time GetLatencyPercentile(uint8_t priority, double quantile) const;
+
+protected:
+    void DoDispose() override;
+
+private:
+    void StartApplication() override;
+    void StopApplication() override;
+    void HandleRead(Ptr<Socket> socket);
+
+    uint16_t m_port;
+    Ptr<Socket> m_socket;
+    std::vector<SojournHistogram> m_latency; ///< Latency per priority
+
+    TracedCallback<Time, uint8_t> m_commandLatencyTrace;
+};
+
+} // namespace ns3
+
+#endif
@@ -2,6 +2,7 @@
 #include "ns3/simulator.h"
 #include "ns3/socket.h"
 #include "ns3/log.h"
+#include "ns3/seq-ts-header.h"
 
 namespace ns3 {
 
@@ -27,7 +28,8 @@ UavCommand::UavCommand()
     : m_running(false),
       m_interval(Seconds(3.0)),
       m_packetSize(100),
-      m_sent(0) {}
+      m_sent(0),
+      m_seq(0) {}
 
 void UavCommand::StartApplication() {
     m_running = true;
@@ -57,7 +59,7 @@ void UavCommand::SendCommandCheck() {
     if (m_sent >= 50) m_interval = Seconds(3.0);
     else m_interval = Seconds(0.05);
     
-    Ptr<Packet> packet = Create<Packet>(m_packetSize);
+    Ptr<Packet> packet = CreateCommandPacket();
     NS_LOG_INFO("Sending command check, size: " << m_packetSize);
     SendWithPriority(packet, PRIO_HIGH);
     m_sent++;
@@ -71,9 +73,19 @@ void UavCommand::SendCommand(Priority priority) {
         return;
     }
     
-    Ptr<Packet> packet = Create<Packet>(m_packetSize);
+    Ptr<Packet> packet = CreateCommandPacket();
     NS_LOG_INFO("Sending command check, size: " << m_packetSize);
     SendWithPriority(packet, priority);
 }
 
+Ptr<Packet> UavCommand::CreateCommandPacket() {
+    // Sequence number and send time let UavCommandReceiver measure latency
+    SeqTsHeader header;
+    header.SetSeq(m_seq++);
+    uint32_t headerSize = header.GetSerializedSize();
+    Ptr<Packet> packet = Create<Packet>(m_packetSize > headerSize ? m_packetSize - headerSize : 0);
+    packet->AddHeader(header);
+    return packet;
+}
+
 } // namespace ns3
\ No newline at end of file
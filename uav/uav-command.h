@@ -5,6 +5,14 @@
 
 namespace ns3 {
 
+/**
+ * \ingroup uav
+ * \brief Ground station application sending commands to a UAV
+ *
+ * Every command starts with a SeqTsHeader carrying a sequence number and
+ * the send time, read back by UavCommandReceiver to measure the
+ * end-to-end latency. "PacketSize" includes the header.
+ */
 class UavCommand : public UavApplication {
 public:
     static TypeId GetTypeId();
@@ -18,12 +26,14 @@ public:
 
 private:
     void SendCommandCheck();
+    Ptr<Packet> CreateCommandPacket();
     
     bool m_running;
     Time m_interval;
     uint32_t m_packetSize;
     EventId m_sendEvent;
     uint32_t m_sent;
+    uint32_t m_seq; ///< Sequence number of the next command
 };
 
 } // namespace ns3
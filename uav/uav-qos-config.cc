@@ -15,29 +15,53 @@ TypeId UavQosConfig::GetTypeId()
 UavQosConfig::UavQosConfig()
     : m_currentMode(NORMAL)
 {
-    // Initialize with default weights
-    SetQueueWeights({50, 30, 15, 5});
+    // Starts with the default QosConfig weights until a mode is set
+    for(std::size_t mode = 0; mode < N_MODES; mode++) {
+        m_modeTables[mode] = GetDefaultModeWeightTable(static_cast<OperationMode>(mode));
+    }
+}
+
+Ptr<const QosWeightTable> UavQosConfig::GetDefaultModeWeightTable(OperationMode mode)
+{
+    static const std::array<Ptr<const QosWeightTable>, N_MODES> defaults = {
+        Create<QosWeightTable>(std::vector<uint32_t>{50, 25, 15, 10}), // NORMAL
+        Create<QosWeightTable>(std::vector<uint32_t>{70, 20, 5, 5}),   // EMERGENCY
+        Create<QosWeightTable>(std::vector<uint32_t>{40, 30, 20, 10}), // LOW_BANDWIDTH
+        Create<QosWeightTable>(std::vector<uint32_t>{20, 20, 35, 25}), // HIGH_QUALITY_VIDEO
+    };
+    return defaults.at(mode);
 }
 
 void UavQosConfig::SetOperationMode(OperationMode mode)
 {
     m_currentMode = mode;
-    
-    switch(mode) {
-        case EMERGENCY:
-            SetQueueWeights({70, 20, 5, 5});
-            break;
-        case LOW_BANDWIDTH:
-            SetQueueWeights({40, 30, 20, 10});
-            break;
-        case HIGH_QUALITY_VIDEO:
-            SetQueueWeights({20, 20, 35, 25});
-            break;
-        default: // NORMAL
-            SetQueueWeights({50, 25, 15, 10});
+    SetWeightTable(m_modeTables.at(mode));
+}
+
+void UavQosConfig::SetModeWeights(OperationMode mode, const std::vector<uint32_t>& weights)
+{
+    SetModeWeightTable(mode, Create<QosWeightTable>(weights));
+}
+
+void UavQosConfig::SetModeWeightTable(OperationMode mode, Ptr<const QosWeightTable> table)
+{
+    NS_ASSERT(table);
+    m_modeTables.at(mode) = table;
+    if(mode == m_currentMode && GetWeightTable() != table) {
+        SetWeightTable(table);
     }
 }
 
+Ptr<const QosWeightTable> UavQosConfig::GetModeWeightTable(OperationMode mode) const
+{
+    return m_modeTables.at(mode);
+}
+
+void UavQosConfig::ResetModeWeights(OperationMode mode)
+{
+    SetModeWeightTable(mode, GetDefaultModeWeightTable(mode));
+}
+
 UavQosConfig::OperationMode UavQosConfig::GetCurrentMode() const
 {
     return m_currentMode;
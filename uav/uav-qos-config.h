@@ -2,9 +2,18 @@
 #define UAV_QOS_CONFIG_H
 
 #include "../priority/qos-config.h"
+#include <array>
 
 namespace ns3 {
 
+/**
+ * \ingroup uav
+ * \brief QosConfig with one weight table per operation mode
+ *
+ * The built-in mode tables are shared by every UavQosConfig, so a mode
+ * change only swaps a pointer. SetModeWeights() overrides the table of
+ * one mode for this config alone.
+ */
 class UavQosConfig : public QosConfig
 {
 public:
@@ -20,11 +29,41 @@ public:
     
     void SetOperationMode(OperationMode mode);
     OperationMode GetCurrentMode() const;
-    
+
+    /**
+     * \brief Override the weights used in a mode
+     * \param mode The operation mode
+     * \param weights Weight per priority (sum should equal 100)
+     */
+    void SetModeWeights(OperationMode mode, const std::vector<uint32_t>& weights);
+
+    /**
+     * \brief Use a shared table for a mode
+     * \param mode The operation mode
+     * \param table The weights, e.g. one table shared by a group of UAVs
+     */
+    void SetModeWeightTable(OperationMode mode, Ptr<const QosWeightTable> table);
+    Ptr<const QosWeightTable> GetModeWeightTable(OperationMode mode) const;
+
+    /**
+     * \brief Go back to the built-in table of a mode
+     * \param mode The operation mode
+     */
+    void ResetModeWeights(OperationMode mode);
+
+    /**
+     * \brief Built-in weights of a mode, shared by all configs
+     * \param mode The operation mode
+     */
+    static Ptr<const QosWeightTable> GetDefaultModeWeightTable(OperationMode mode);
+
 private:
+    static constexpr std::size_t N_MODES = HIGH_QUALITY_VIDEO + 1;
+
     OperationMode m_currentMode;
+    std::array<Ptr<const QosWeightTable>, N_MODES> m_modeTables; ///< Weights per mode
 };
 
 } // namespace ns3
 
-#endif
\ No newline at end of file
+#endif
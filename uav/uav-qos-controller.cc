@@ -0,0 +1,211 @@
+#include "uav-qos-controller.h"
+#include "uav-application.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/wifi-net-device.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("UavQosController");
+NS_OBJECT_ENSURE_REGISTERED(UavQosController);
+
+TypeId UavQosController::GetTypeId() {
+    static TypeId tid = TypeId("ns3::UavQosController")
+        .SetParent<Object>()
+        .AddConstructor<UavQosController>()
+        .AddAttribute("Interval", "Sampling period of the link state",
+                     TimeValue(MilliSeconds(100)),
+                     MakeTimeAccessor(&UavQosController::m_interval),
+                     MakeTimeChecker())
+        .AddAttribute("HoldTime", "Minimum time spent in a mode before leaving it",
+                     TimeValue(Seconds(1.0)),
+                     MakeTimeAccessor(&UavQosController::m_holdTime),
+                     MakeTimeChecker())
+        .AddAttribute("DepthHigh", "Queue depth in packets that signals congestion",
+                     UintegerValue(80),
+                     MakeUintegerAccessor(&UavQosController::m_depthHigh),
+                     MakeUintegerChecker<uint32_t>())
+        .AddAttribute("DepthLow", "Queue depth in packets that clears congestion",
+                     UintegerValue(20),
+                     MakeUintegerAccessor(&UavQosController::m_depthLow),
+                     MakeUintegerChecker<uint32_t>())
+        .AddAttribute("CriticalSojournHigh", "Critical class sojourn time that enters EMERGENCY",
+                     TimeValue(MilliSeconds(20)),
+                     MakeTimeAccessor(&UavQosController::m_criticalHigh),
+                     MakeTimeChecker())
+        .AddAttribute("CriticalSojournLow", "Critical class sojourn time that leaves EMERGENCY",
+                     TimeValue(MilliSeconds(5)),
+                     MakeTimeAccessor(&UavQosController::m_criticalLow),
+                     MakeTimeChecker())
+        .AddAttribute("VideoSojournTarget",
+                     "Video class sojourn time below which HIGH_QUALITY_VIDEO is allowed",
+                     TimeValue(MilliSeconds(50)),
+                     MakeTimeAccessor(&UavQosController::m_videoTarget),
+                     MakeTimeChecker())
+        .AddAttribute("VideoMinSamples",
+                     "Video packets sent in an interval before its sojourn time may "
+                     "allow HIGH_QUALITY_VIDEO",
+                     UintegerValue(10),
+                     MakeUintegerAccessor(&UavQosController::m_videoMinSamples),
+                     MakeUintegerChecker<uint32_t>(1))
+        .AddAttribute("SnrLow", "Link SNR in dB that enters LOW_BANDWIDTH",
+                     DoubleValue(10.0),
+                     MakeDoubleAccessor(&UavQosController::m_snrLow),
+                     MakeDoubleChecker<double>())
+        .AddAttribute("SnrHigh", "Link SNR in dB that leaves LOW_BANDWIDTH",
+                     DoubleValue(15.0),
+                     MakeDoubleAccessor(&UavQosController::m_snrHigh),
+                     MakeDoubleChecker<double>())
+        .AddAttribute("CriticalClass", "Priority index of critical traffic",
+                     UintegerValue(PRIO_CRITICAL),
+                     MakeUintegerAccessor(&UavQosController::m_criticalClass),
+                     MakeUintegerChecker<uint32_t>(0, 63))
+        .AddAttribute("VideoClass", "Priority index of video traffic",
+                     UintegerValue(PRIO_NORMAL),
+                     MakeUintegerAccessor(&UavQosController::m_videoClass),
+                     MakeUintegerChecker<uint32_t>(0, 63))
+        .AddTraceSource("ModeChange", "The operation mode changed",
+                     MakeTraceSourceAccessor(&UavQosController::m_modeChangeTrace),
+                     "ns3::UavQosController::ModeChangeTracedCallback");
+    return tid;
+}
+
+UavQosController::UavQosController()
+    : m_videoMinSamples(10),
+      m_snr(0.0),
+      m_snrKnown(false),
+      m_emergency(false),
+      m_degraded(false) {}
+
+void UavQosController::SetQosConfig(Ptr<UavQosConfig> config) {
+    m_config = config;
+}
+
+void UavQosController::AttachQueue(Ptr<PriorityTxQueue> queue) {
+    m_queues.push_back(queue);
+    queue->TraceConnectWithoutContext("SojournTime",
+                                      MakeCallback(&UavQosController::RecordSojourn, this));
+}
+
+void UavQosController::ReportSnr(double snrDb) {
+    // Smooth out per-frame fading
+    m_snr = m_snrKnown ? 0.9 * m_snr + 0.1 * snrDb : snrDb;
+    m_snrKnown = true;
+}
+
+void UavQosController::AttachDevice(Ptr<NetDevice> device) {
+    Ptr<WifiNetDevice> wifi = DynamicCast<WifiNetDevice>(device);
+    if(!wifi) {
+        NS_LOG_DEBUG("Device " << device->GetIfIndex() << " is not Wi-Fi, no SNR taken");
+        return;
+    }
+    Ptr<WifiPhy> phy = wifi->GetPhy();
+    phy->TraceConnectWithoutContext("MonitorSnifferRx",
+                                    MakeCallback(&UavQosController::MonitorSnifferRx, this));
+    m_phys.push_back(phy);
+}
+
+void UavQosController::MonitorSnifferRx(Ptr<const Packet> packet, uint16_t channelFreqMhz,
+                                        WifiTxVector txVector, MpduInfo aMpdu,
+                                        SignalNoiseDbm signalNoise, uint16_t staId) {
+    ReportSnr(signalNoise.signal - signalNoise.noise);
+}
+
+void UavQosController::Start() {
+    NS_ASSERT_MSG(m_config, "SetQosConfig must be called before Start");
+    m_lastChange = Simulator::Now();
+    m_sampleEvent = Simulator::Schedule(m_interval, &UavQosController::Sample, this);
+}
+
+void UavQosController::Stop() {
+    Simulator::Cancel(m_sampleEvent);
+}
+
+void UavQosController::DoDispose() {
+    Stop();
+    for(const Ptr<WifiPhy>& phy : m_phys) {
+        phy->TraceDisconnectWithoutContext("MonitorSnifferRx",
+                                           MakeCallback(&UavQosController::MonitorSnifferRx, this));
+    }
+    m_phys.clear();
+    m_queues.clear();
+    m_config = nullptr;
+    Object::DoDispose();
+}
+
+void UavQosController::RecordSojourn(Time sojourn, uint8_t priority) {
+    if(priority >= m_sojournSum.size()) {
+        m_sojournSum.resize(priority + 1);
+        m_sojournCount.resize(priority + 1, 0);
+    }
+    m_sojournSum[priority] += sojourn;
+    m_sojournCount[priority]++;
+}
+
+Time UavQosController::GetMeanSojourn(uint8_t priority) const {
+    if(priority >= m_sojournSum.size() || m_sojournCount[priority] == 0) {
+        return Time(0);
+    }
+    return m_sojournSum[priority] / m_sojournCount[priority];
+}
+
+void UavQosController::Sample() {
+    uint32_t depth = 0;
+    for(const Ptr<PriorityTxQueue>& queue : m_queues) {
+        depth = std::max(depth, queue->GetNPackets());
+    }
+    Time critical = GetMeanSojourn(m_criticalClass);
+    Time video = GetMeanSojourn(m_videoClass);
+    bool videoMeasured = m_videoClass < m_sojournCount.size() &&
+                         m_sojournCount[m_videoClass] >= m_videoMinSamples;
+    std::fill(m_sojournSum.begin(), m_sojournSum.end(), Time(0));
+    std::fill(m_sojournCount.begin(), m_sojournCount.end(), 0);
+
+    // Each condition has separate enter and leave thresholds
+    if(!m_emergency && critical > m_criticalHigh) {
+        m_emergency = true;
+    } else if(m_emergency && critical < m_criticalLow) {
+        m_emergency = false;
+    }
+    bool weakLink = m_snrKnown && m_snr < m_snrLow;
+    bool goodLink = !m_snrKnown || m_snr > m_snrHigh;
+    if(!m_degraded && (weakLink || depth > m_depthHigh)) {
+        m_degraded = true;
+    } else if(m_degraded && goodLink && depth < m_depthLow) {
+        m_degraded = false;
+    }
+    // Without video traffic the mean sojourn is 0, which proves nothing
+    bool spare = goodLink && depth < m_depthLow && videoMeasured && video < m_videoTarget;
+
+    UavQosConfig::OperationMode mode = UavQosConfig::NORMAL;
+    if(m_emergency) {
+        mode = UavQosConfig::EMERGENCY;
+    } else if(m_degraded) {
+        mode = UavQosConfig::LOW_BANDWIDTH;
+    } else if(spare) {
+        mode = UavQosConfig::HIGH_QUALITY_VIDEO;
+    }
+    NS_LOG_LOGIC("Depth " << depth << " critical " << critical << " video " << video
+                 << " snr " << m_snr << " -> mode " << mode);
+
+    if(mode != m_config->GetCurrentMode() &&
+       (mode == UavQosConfig::EMERGENCY || Simulator::Now() - m_lastChange >= m_holdTime)) {
+        Transition(mode);
+    }
+    m_sampleEvent = Simulator::Schedule(m_interval, &UavQosController::Sample, this);
+}
+
+void UavQosController::Transition(UavQosConfig::OperationMode mode) {
+    UavQosConfig::OperationMode oldMode = m_config->GetCurrentMode();
+    NS_LOG_INFO("QoS mode " << oldMode << " -> " << mode << " at "
+                << Simulator::Now().GetSeconds() << "s");
+    // Queues subscribed to the config pick up the new weights themselves
+    m_config->SetOperationMode(mode);
+    m_lastChange = Simulator::Now();
+    m_modeChangeTrace(oldMode, mode);
+}
+
+} // namespace ns3
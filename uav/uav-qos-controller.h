@@ -0,0 +1,136 @@
+#ifndef UAV_QOS_CONTROLLER_H
+#define UAV_QOS_CONTROLLER_H
+
+#include "uav-qos-config.h"
+#include "../priority/priority-tx-queue.h"
+#include "ns3/event-id.h"
+#include "ns3/net-device.h"
+#include "ns3/nstime.h"
+#include "ns3/traced-callback.h"
+#include "ns3/wifi-phy.h"
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup uav
+ * \brief Switches the UavQosConfig operation mode from measured link state
+ *
+ * Every "Interval" the controller samples the deepest attached queue, the
+ * mean sojourn time of the critical and video classes over the interval
+ * (from the queues' SojournTime trace) and the link SNR reported through
+ * ReportSnr(), e.g. by the Wi-Fi devices given to AttachDevice(), then
+ * picks the mode:
+ *
+ * - EMERGENCY while the critical class waits longer than
+ *   "CriticalSojournHigh", until it drops below "CriticalSojournLow";
+ * - LOW_BANDWIDTH while the SNR is below "SnrLow" or the queue holds more
+ *   than "DepthHigh" packets, until the SNR is above "SnrHigh" and the
+ *   queue below "DepthLow";
+ * - HIGH_QUALITY_VIDEO when the link is good, the queue is below
+ *   "DepthLow" and video waits less than "VideoSojournTarget" over at
+ *   least "VideoMinSamples" packets, so an idle link stays in NORMAL;
+ * - NORMAL otherwise.
+ *
+ * Besides the threshold pairs, a mode is held for at least "HoldTime"
+ * before the controller leaves it, except to enter EMERGENCY. On every
+ * transition the mode is set on the shared UavQosConfig, which notifies
+ * every subscribed queue, and the ModeChange trace fires.
+ */
+class UavQosController : public Object
+{
+public:
+    /**
+     * \brief TracedCallback signature for mode transitions
+     * \param [in] oldMode The mode left
+     * \param [in] newMode The mode entered
+     */
+    typedef void (*ModeChangeTracedCallback)(UavQosConfig::OperationMode oldMode,
+                                             UavQosConfig::OperationMode newMode);
+
+    static TypeId GetTypeId();
+    UavQosController();
+
+    /**
+     * \brief Set the configuration whose mode is switched
+     * \param config The shared QoS configuration
+     */
+    void SetQosConfig(Ptr<UavQosConfig> config);
+
+    /**
+     * \brief Watch the depth and sojourn times of a queue
+     * \param queue A queue configured with the same UavQosConfig
+     */
+    void AttachQueue(Ptr<PriorityTxQueue> queue);
+
+    /**
+     * \brief Report a link quality sample
+     * \param snrDb Signal to noise ratio in dB, e.g. from a Wi-Fi
+     *        MonitorSnifferRx trace
+     */
+    void ReportSnr(double snrDb);
+
+    /**
+     * \brief Take the SNR of the frames a device receives
+     * \param device A WifiNetDevice; its PHY "MonitorSnifferRx" trace feeds
+     *        ReportSnr() with signal minus noise. Other devices are ignored.
+     */
+    void AttachDevice(Ptr<NetDevice> device);
+
+    /**
+     * \brief Start periodic sampling
+     */
+    void Start();
+
+    /**
+     * \brief Stop periodic sampling
+     */
+    void Stop();
+
+protected:
+    void DoDispose() override;
+
+private:
+    void Sample();
+    void RecordSojourn(Time sojourn, uint8_t priority);
+    void MonitorSnifferRx(Ptr<const Packet> packet, uint16_t channelFreqMhz, WifiTxVector txVector,
+                          MpduInfo aMpdu, SignalNoiseDbm signalNoise, uint16_t staId);
+    void Transition(UavQosConfig::OperationMode mode);
+
+    /**
+     * \brief Mean sojourn time of a class since the last sample
+     */
+    Time GetMeanSojourn(uint8_t priority) const;
+
+    Ptr<UavQosConfig> m_config;
+    std::vector<Ptr<PriorityTxQueue>> m_queues;
+    std::vector<Ptr<WifiPhy>> m_phys; ///< PHYs whose MonitorSnifferRx is connected
+    EventId m_sampleEvent;
+
+    Time m_interval;
+    Time m_holdTime;
+    uint32_t m_depthHigh;
+    uint32_t m_depthLow;
+    Time m_criticalHigh;
+    Time m_criticalLow;
+    Time m_videoTarget;
+    uint32_t m_videoMinSamples; ///< Video packets per interval needed to judge its sojourn
+    double m_snrLow;
+    double m_snrHigh;
+    uint32_t m_criticalClass;
+    uint32_t m_videoClass;
+
+    std::vector<Time> m_sojournSum;       ///< Sojourn time sum per class this interval
+    std::vector<uint32_t> m_sojournCount; ///< Samples per class this interval
+    double m_snr;          ///< Smoothed SNR in dB
+    bool m_snrKnown;       ///< Whether any SNR was reported
+    bool m_emergency;      ///< Critical class latency condition
+    bool m_degraded;       ///< Link or queue congestion condition
+    Time m_lastChange;     ///< Time of the last transition
+
+    TracedCallback<UavQosConfig::OperationMode, UavQosConfig::OperationMode> m_modeChangeTrace;
+};
+
+} // namespace ns3
+
+#endif
@@ -0,0 +1,99 @@
+#include "uav-qos-helper.h"
+#include "ns3/data-rate.h"
+#include "ns3/log.h"
+#include "ns3/net-device-queue-interface.h"
+#include "ns3/pointer.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("UavQosHelper");
+
+UavQosHelper::UavQosHelper()
+    : m_mode(UavQosConfig::NORMAL),
+      m_modeSet(false),
+      m_cycleBudget(0) {
+    m_queueFactory.SetTypeId(PriorityTxQueue::GetTypeId());
+}
+
+void UavQosHelper::SetQueueAttribute(std::string name, const AttributeValue& value) {
+    m_queueFactory.Set(name, value);
+}
+
+void UavQosHelper::SetOperationMode(UavQosConfig::OperationMode mode) {
+    m_mode = mode;
+    m_modeSet = true;
+}
+
+void UavQosHelper::SetModeWeights(UavQosConfig::OperationMode mode,
+                                  const std::vector<uint32_t>& weights) {
+    Ptr<const QosWeightTable> previous = m_modeTables.count(mode)
+        ? m_modeTables[mode]
+        : UavQosConfig::GetDefaultModeWeightTable(mode);
+    Ptr<const QosWeightTable> table = Create<QosWeightTable>(weights);
+    m_modeTables[mode] = table;
+    for(auto& entry : m_configs) {
+        // Nodes with their own table for this mode keep it
+        if(entry.second->GetModeWeightTable(mode) == previous) {
+            entry.second->SetModeWeightTable(mode, table);
+        }
+    }
+}
+
+void UavQosHelper::SetCycleBudget(uint32_t cycleBudget) {
+    m_cycleBudget = cycleBudget;
+    for(auto& entry : m_configs) {
+        entry.second->SetCycleBudget(cycleBudget);
+    }
+}
+
+std::vector<Ptr<PriorityTxQueue>> UavQosHelper::Install(const NetDeviceContainer& devices) {
+    std::vector<Ptr<PriorityTxQueue>> queues;
+    queues.reserve(devices.GetN());
+    for(auto it = devices.Begin(); it != devices.End(); ++it) {
+        queues.push_back(Install(*it));
+    }
+    return queues;
+}
+
+Ptr<PriorityTxQueue> UavQosHelper::Install(Ptr<NetDevice> device) {
+    Ptr<PriorityTxQueue> queue = m_queueFactory.Create<PriorityTxQueue>();
+    queue->SetQosConfig(GetQosConfig(device->GetNode()));
+
+    bool replaced = device->SetAttributeFailSafe("TxQueue", PointerValue(queue));
+    NS_ABORT_MSG_UNLESS(replaced, "Device " << device->GetIfIndex() << " of node "
+                        << device->GetNode()->GetId()
+                        << " has no TxQueue; install a PriorityQueueDisc instead");
+
+    // Keep flow control working with the new queue
+    Ptr<NetDeviceQueueInterface> ndqi = device->GetObject<NetDeviceQueueInterface>();
+    if(ndqi) {
+        ndqi->GetTxQueue(0)->ConnectQueueTraces(queue);
+    }
+
+    DataRateValue rate;
+    if(device->GetAttributeFailSafe("DataRate", rate)) {
+        queue->AttachToDevice(device);
+    }
+    NS_LOG_DEBUG("Installed PriorityTxQueue on device " << device->GetIfIndex()
+                 << " of node " << device->GetNode()->GetId());
+    return queue;
+}
+
+Ptr<UavQosConfig> UavQosHelper::GetQosConfig(Ptr<Node> node) {
+    Ptr<UavQosConfig>& config = m_configs[node->GetId()];
+    if(!config) {
+        config = CreateObject<UavQosConfig>();
+        for(const auto& entry : m_modeTables) {
+            config->SetModeWeightTable(entry.first, entry.second);
+        }
+        if(m_cycleBudget > 0) {
+            config->SetCycleBudget(m_cycleBudget);
+        }
+        if(m_modeSet) {
+            config->SetOperationMode(m_mode);
+        }
+    }
+    return config;
+}
+
+} // namespace ns3
@@ -0,0 +1,96 @@
+#ifndef UAV_QOS_HELPER_H
+#define UAV_QOS_HELPER_H
+
+#include "uav-qos-config.h"
+#include "../priority/priority-tx-queue.h"
+#include "ns3/net-device-container.h"
+#include "ns3/node.h"
+#include "ns3/object-factory.h"
+#include <map>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup uav
+ * \brief Installs PriorityTxQueues across a fleet of UAVs
+ *
+ * Every node gets one UavQosConfig, shared by the queues of all its
+ * devices, so a mode change on a UAV re-tunes all of its interfaces and
+ * no other UAV. The configs point at the built-in mode tables, or at
+ * fleet-wide tables set with SetModeWeights(), which are built once and
+ * shared by every node: memory per UAV is one small config object
+ * whatever the fleet size. Per-node overrides go through
+ * GetQosConfig(node)->SetModeWeights() and only affect that node.
+ *
+ * The queue replaces the "TxQueue" of the device, which covers
+ * point-to-point and CSMA devices. Wi-Fi devices have no such queue; use
+ * PriorityQueueDisc on them instead.
+ */
+class UavQosHelper
+{
+public:
+    UavQosHelper();
+
+    /**
+     * \brief Set an attribute of the installed queues
+     * \param name The attribute name, e.g. "Scheduler"
+     * \param value The attribute value
+     */
+    void SetQueueAttribute(std::string name, const AttributeValue& value);
+
+    /**
+     * \brief Set the mode the node configs start in
+     * \param mode The operation mode
+     */
+    void SetOperationMode(UavQosConfig::OperationMode mode);
+
+    /**
+     * \brief Set the weights of a mode for the whole fleet
+     * \param mode The operation mode
+     * \param weights Weight per priority (sum should equal 100)
+     *
+     * One table is built and shared by every node config, including the
+     * ones already installed, except nodes that override the mode.
+     */
+    void SetModeWeights(UavQosConfig::OperationMode mode, const std::vector<uint32_t>& weights);
+
+    /**
+     * \brief Set the cycle budget of every node config, installed or not
+     * \param cycleBudget Bytes per scheduling cycle, 0 for the queue default
+     */
+    void SetCycleBudget(uint32_t cycleBudget);
+
+    /**
+     * \brief Install a priority queue on each device
+     * \param devices The devices
+     * \return The queues, in device order
+     */
+    std::vector<Ptr<PriorityTxQueue>> Install(const NetDeviceContainer& devices);
+
+    /**
+     * \brief Install a priority queue on a device
+     * \param device The device
+     * \return The queue
+     */
+    Ptr<PriorityTxQueue> Install(Ptr<NetDevice> device);
+
+    /**
+     * \brief Get the config shared by the queues of a node
+     * \param node The node
+     * \return Its config, created on first use
+     */
+    Ptr<UavQosConfig> GetQosConfig(Ptr<Node> node);
+
+private:
+    ObjectFactory m_queueFactory;           ///< Creates the queues
+    UavQosConfig::OperationMode m_mode;     ///< Initial mode of new configs
+    bool m_modeSet;                         ///< Whether SetOperationMode was called
+    uint32_t m_cycleBudget;                 ///< Cycle budget of new configs
+    std::map<UavQosConfig::OperationMode, Ptr<const QosWeightTable>> m_modeTables; ///< Fleet-wide tables
+    std::map<uint32_t, Ptr<UavQosConfig>> m_configs; ///< Config per node id
+};
+
+} // namespace ns3
+
+#endif
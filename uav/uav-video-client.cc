@@ -11,7 +11,11 @@
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
 #include "ns3/trace-source-accessor.h"
+#include <algorithm>
 #include "uav-application.h"
+#include "uav-video-header.h"
+#include "ns3/object-factory.h"
+#include "ns3/type-id.h"
 
 NS_LOG_COMPONENT_DEFINE("UavVideoClient");
 
@@ -22,18 +26,183 @@ TypeId UavVideoClient::GetTypeId()
 {
     static TypeId tid = TypeId("ns3::UavVideoStreamClient")
                         .SetParent<VideoStreamClient>()
-                        .AddConstructor<UavVideoClient>();
+                        .AddConstructor<UavVideoClient>()
+                        .AddAttribute ("StartupFrames", "Complete frames buffered before playback starts",
+                                       UintegerValue (15),
+                                       MakeUintegerAccessor (&UavVideoClient::m_startupFrames),
+                                       MakeUintegerChecker<uint32_t> (1))
+                        .AddAttribute ("PlayoutWindow", "Frames tracked for reassembly ahead of the playout point",
+                                       UintegerValue (256),
+                                       MakeUintegerAccessor (&UavVideoClient::m_playoutWindow),
+                                       MakeUintegerChecker<uint32_t> (1))
+                        .AddAttribute ("AbrType", "Quality adaptation strategy, a subclass of ns3::UavAbrAlgorithm",
+                                       TypeIdValue (UavBbaAbr::GetTypeId ()),
+                                       MakeTypeIdAccessor (&UavVideoClient::m_abrType),
+                                       MakeTypeIdChecker ())
+                        .AddAttribute ("AbrInterval", "Minimum time between two quality decisions",
+                                       TimeValue (Seconds (1)),
+                                       MakeTimeAccessor (&UavVideoClient::m_abrInterval),
+                                       MakeTimeChecker ())
+                        .AddAttribute ("SummaryInterval", "Period of the QoE summary, zero to disable",
+                                       TimeValue (Seconds (1)),
+                                       MakeTimeAccessor (&UavVideoClient::m_summaryInterval),
+                                       MakeTimeChecker ())
+                        .AddTraceSource ("Startup", "Playback started, with the startup delay",
+                                         MakeTraceSourceAccessor (&UavVideoClient::m_startupTrace),
+                                         "ns3::Time::TracedCallback")
+                        .AddTraceSource ("FramePlayed", "A frame was complete at its deadline",
+                                         MakeTraceSourceAccessor (&UavVideoClient::m_framePlayedTrace),
+                                         "ns3::UavVideoClient::FrameTracedCallback")
+                        .AddTraceSource ("FrameLost", "A frame missed fragments at its deadline",
+                                         MakeTraceSourceAccessor (&UavVideoClient::m_frameLostTrace),
+                                         "ns3::UavVideoClient::FrameTracedCallback")
+                        .AddTraceSource ("Stall", "A stall ended, with its duration",
+                                         MakeTraceSourceAccessor (&UavVideoClient::m_stallTrace),
+                                         "ns3::Time::TracedCallback")
+                        .AddTraceSource ("QualityChange", "The client switched the video level",
+                                         MakeTraceSourceAccessor (&UavVideoClient::m_qualityChangeTrace),
+                                         "ns3::UavVideoClient::QualityChangeTracedCallback")
+                        .AddTraceSource ("QoeSummary", "Periodic summary of the QoE counters",
+                                         MakeTraceSourceAccessor (&UavVideoClient::m_qoeSummaryTrace),
+                                         "ns3::UavVideoClient::QoeSummaryTracedCallback");
     return tid;
 }
 
 UavVideoClient::UavVideoClient() 
+  : m_startupFrames (15),
+    m_playoutWindow (256),
+    m_summaryInterval (Seconds (1)),
+    m_abrType (UavBbaAbr::GetTypeId ()),
+    m_abrInterval (Seconds (1)),
+    m_framesComplete (0)
 {
 }
 
+uint32_t UavVideoClient::GetFramesComplete () const
+{
+  return m_framesComplete;
+}
+
+uint32_t UavVideoClient::GetFramesIncomplete () const
+{
+  return m_playout.GetStats ().framesLost;
+}
+
+const UavVideoPlayout::Stats& UavVideoClient::GetQoeStats () const
+{
+  return m_playout.GetStats ();
+}
+
 UavVideoClient::~UavVideoClient() {}
 
+void UavVideoClient::SetAbr (Ptr<UavAbrAlgorithm> abr)
+{
+  m_abr = abr;
+}
 
+Ptr<UavAbrAlgorithm> UavVideoClient::GetAbr (void) const
+{
+  return m_abr;
+}
 
+void UavVideoClient::DoInitialize (void)
+{
+  // The attributes are set by now
+  m_playout = UavVideoPlayout (m_playoutWindow, m_startupFrames);
+  if (!m_abr)
+  {
+    ObjectFactory factory (m_abrType.GetName ());
+    m_abr = factory.Create<UavAbrAlgorithm> ();
+  }
+  VideoStreamClient::DoInitialize ();
+}
+
+void UavVideoClient::DoDispose (void)
+{
+  Simulator::Cancel (m_playEvent);
+  Simulator::Cancel (m_summaryEvent);
+  m_abr = nullptr;
+  VideoStreamClient::DoDispose ();
+}
+
+void UavVideoClient::StopApplication (void)
+{
+  // No frame deadlines or summaries once the stream stops
+  Simulator::Cancel (m_playEvent);
+  Simulator::Cancel (m_summaryEvent);
+  VideoStreamClient::StopApplication ();
+}
+
+void UavVideoClient::UpdatePlayout (void)
+{
+  if (m_playout.CanStart ())
+  {
+    m_playout.Start (Simulator::Now ());
+    Time delay = m_playout.GetStats ().startupDelay;
+    NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds () << "s client started playback after " << delay.GetSeconds () << "s");
+    m_startupTrace (delay);
+    m_playEvent = Simulator::ScheduleNow (&UavVideoClient::PlayFrame, this);
+    if (m_summaryInterval.IsStrictlyPositive ())
+    {
+      m_summaryEvent = Simulator::Schedule (m_summaryInterval, &UavVideoClient::Summary, this);
+    }
+  }
+  else if (m_playout.CanResume ())
+  {
+    Time duration = m_playout.Resume (Simulator::Now ());
+    NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds () << "s client resumed playback after a " << duration.GetSeconds () << "s stall");
+    m_stallTrace (duration);
+    m_playEvent = Simulator::ScheduleNow (&UavVideoClient::PlayFrame, this);
+  }
+}
+
+void UavVideoClient::PlayFrame (void)
+{
+  uint32_t frame;
+  switch (m_playout.Tick (Simulator::Now (), frame))
+  {
+    case UavVideoPlayout::PLAYED:
+      m_framePlayedTrace (frame);
+      break;
+    case UavVideoPlayout::LOST:
+      NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds () << "s client lost frame " << frame);
+      m_frameLostTrace (frame);
+      break;
+    case UavVideoPlayout::STALLED:
+      // Resumed from HandleRead once the frame or later data arrives
+      NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds () << "s client stalled at frame " << frame);
+      return;
+  }
+  m_playEvent = Simulator::Schedule (Seconds (1.0 / std::max<uint32_t> (m_frameRate, 1)), &UavVideoClient::PlayFrame, this);
+}
+
+void UavVideoClient::Summary (void)
+{
+  const UavVideoPlayout::Stats& stats = m_playout.GetStats ();
+  NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds () << "s QoE: startup " << stats.startupDelay.GetSeconds ()
+               << "s, played " << stats.framesPlayed << ", lost " << stats.framesLost
+               << " (" << stats.GetLossRatio () * 100 << "%), stalls " << stats.stalls
+               << " (" << stats.stallTime.GetSeconds () << "s), switches " << stats.switches);
+  m_qoeSummaryTrace (stats);
+  m_summaryEvent = Simulator::Schedule (m_summaryInterval, &UavVideoClient::Summary, this);
+}
+
+void UavVideoClient::ChangeLevel (Ptr<Socket> socket, const Address& to, uint16_t level)
+{
+  uint16_t oldLevel = m_videoLevel;
+  m_videoLevel = level;
+  m_playout.RecordSwitch ();
+  m_qualityChangeTrace (oldLevel, level);
+
+  // reflect the change to the server, which parses the level as text
+  uint8_t dataBuffer[10] = {};
+  snprintf ((char *) dataBuffer, sizeof (dataBuffer), "%hu", m_videoLevel);
+  Ptr<Packet> levelPacket = Create<Packet> (dataBuffer, sizeof (dataBuffer));
+
+  PriorityTag priorityTag(PRIO_HIGH);
+  levelPacket->AddPacketTag(priorityTag);
+  socket->SendTo (levelPacket, 0, to);
+}
 
 void UavVideoClient::HandleRead(Ptr<Socket> socket)
 {
@@ -47,63 +216,42 @@ void UavVideoClient::HandleRead(Ptr<Socket> socket)
     socket->GetSockName (localAddress);
     if (InetSocketAddress::IsMatchingType (from))
     {
-      uint8_t recvData[packet->GetSize()];
-      packet->CopyData (recvData, packet->GetSize ());
-      uint32_t frameNum;
-      sscanf ((char *) recvData, "%u", &frameNum);
-
-      if (frameNum == m_lastRecvFrame)
+      UavVideoHeader header;
+      if (packet->GetSize () < header.GetSerializedSize ())
       {
-        m_frameSize += packet->GetSize ();
+        continue;
       }
-      else
-      {
-        if (frameNum > 0)
-        {
-          NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds () << "s client received frame " << frameNum-1 << " and " << m_frameSize << " bytes from " <<  InetSocketAddress::ConvertFrom (from).GetIpv4 () << " port " << InetSocketAddress::ConvertFrom (from).GetPort ());
-        }
+      packet->PeekHeader (header);
+      uint32_t frameNum = header.GetFrame ();
 
-        m_currentBufferSize++;
+      if (m_playout.AddFragment (Simulator::Now (), frameNum, header.GetFragmentCount (), packet->GetSize ()))
+      {
+        NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds () << "s client received frame " << frameNum << " from " <<  InetSocketAddress::ConvertFrom (from).GetIpv4 () << " port " << InetSocketAddress::ConvertFrom (from).GetPort ());
         m_lastRecvFrame = frameNum;
-        m_frameSize = packet->GetSize ();
+        m_currentBufferSize++;
+        m_framesComplete++;
+        const UavVideoPlayout::CompleteFrame& complete = m_playout.GetLastComplete ();
+        m_abr->ReportFrame (m_videoLevel, complete.bytes, complete.firstBytes, complete.spread);
       }
+      UpdatePlayout ();
 
-      // The rebuffering event has happend 3+ times, which suggest the client to lower the video quality.
-      if (m_rebufferCounter >= 3)
+      if (Simulator::Now () - m_lastAbr >= m_abrInterval)
       {
-        if (m_videoLevel > 1)
+        m_lastAbr = Simulator::Now ();
+        UavAbrState state;
+        state.level = m_videoLevel;
+        state.maxLevel = MAX_VIDEO_LEVEL;
+        state.frameRate = std::max<uint32_t> (m_frameRate, 1);
+        state.buffer = Seconds (m_playout.GetBufferedFrames () / state.frameRate);
+        uint16_t level = std::min<uint16_t> (std::max<uint16_t> (m_abr->SelectLevel (state), 1), MAX_VIDEO_LEVEL);
+        if (level != m_videoLevel)
         {
-          NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds () << "s: Lower the video quality level!");
-          m_videoLevel--;
-          // reflect the change to the server
-          uint8_t dataBuffer[10];
-          sprintf((char *) dataBuffer, "%hu", m_videoLevel);
-          Ptr<Packet> levelPacket = Create<Packet> (dataBuffer, 10);
-
-          PriorityTag priorityTag(PRIO_HIGH);
-          levelPacket->AddPacketTag(priorityTag);
-          socket->SendTo (levelPacket, 0, from);
-          m_rebufferCounter = 0;
-        }
-      }
-      
-      // If the current buffer size supports 5+ seconds video, we can try to increase the video quality level.
-      if (m_currentBufferSize > 5 * m_frameRate)
-      {
-        if (m_videoLevel < MAX_VIDEO_LEVEL)
-        {
-          m_videoLevel++;
-          // reflect the change to the server
-          uint8_t dataBuffer[10];
-          sprintf((char *) dataBuffer, "%hu", m_videoLevel);
-          Ptr<Packet> levelPacket = Create<Packet> (dataBuffer, 10);
-          socket->SendTo (levelPacket, 0, from);
-          m_currentBufferSize = m_frameRate;
-          NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds() << "s: Increase the video quality level to " << m_videoLevel);
+          NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds () << "s: Change the video quality level from " << m_videoLevel << " to " << level);
+          ChangeLevel (socket, from, level);
         }
       }
     }
   }
 }
 
-}
\ No newline at end of file
+}
@@ -2,26 +2,134 @@
 #define UAV_VIDEO_CLIENT_H
 
 #include "ns3/video-stream-client.h"
+#include "ns3/event-id.h"
+#include "ns3/traced-callback.h"
 #include "../priority/priority-tx-queue.h"
+#include "uav-abr.h"
+#include "uav-video-playout.h"
 
 namespace ns3 {
 
 class Socket;
 class Packet;
     
+/**
+ * \ingroup uav
+ * \brief VideoStreamClient that reads the binary UavVideoHeader
+ *
+ * Fragments are reassembled into frames and played out by a
+ * UavVideoPlayout at the frame rate, once "StartupFrames" frames are
+ * buffered. Startup delay, stalls, lost frames and quality switches are
+ * reported through trace sources as they happen, and every
+ * "SummaryInterval" through the "QoeSummary" trace source and the log.
+ *
+ * The level to request is chosen by a UavAbrAlgorithm of type "AbrType"
+ * at most every "AbrInterval", unless one is given with SetAbr().
+ */
 class UavVideoClient : public VideoStreamClient 
 {
 public: 
     static TypeId GetTypeId();
 
+    /**
+     * \brief TracedCallback signature for frame events
+     * \param [in] frame The frame number
+     */
+    typedef void (*FrameTracedCallback)(uint32_t frame);
+
+    /**
+     * \brief TracedCallback signature for quality level changes
+     * \param [in] oldLevel The previous video level
+     * \param [in] newLevel The new video level
+     */
+    typedef void (*QualityChangeTracedCallback)(uint16_t oldLevel, uint16_t newLevel);
+
+    /**
+     * \brief TracedCallback signature for QoE summaries
+     * \param [in] stats The counters since the start of the stream
+     */
+    typedef void (*QoeSummaryTracedCallback)(const UavVideoPlayout::Stats& stats);
+
     UavVideoClient();
     virtual ~UavVideoClient();
 
+    /**
+     * \brief Get the number of frames whose fragments all arrived
+     */
+    uint32_t GetFramesComplete () const;
+
+    /**
+     * \brief Get the number of frames that missed fragments
+     */
+    uint32_t GetFramesIncomplete () const;
+
+    /**
+     * \brief Use a configured quality adaptation strategy
+     * \param abr The strategy, replacing the one made from "AbrType"
+     */
+    void SetAbr (Ptr<UavAbrAlgorithm> abr);
+    Ptr<UavAbrAlgorithm> GetAbr (void) const;
+
+    /**
+     * \brief Get the QoE counters since the start of the stream
+     */
+    const UavVideoPlayout::Stats& GetQoeStats () const;
+
+protected:
+    virtual void DoInitialize (void) override;
+    virtual void DoDispose (void) override;
+
 private:
 
+    /**
+     * \brief Stop the playout and summary events, then the stream
+     */
+    virtual void StopApplication (void) override;
+
     virtual void HandleRead (Ptr<Socket> socket) override;
 
+    /**
+     * \brief Start or resume playing if enough frames arrived
+     */
+    void UpdatePlayout (void);
+
+    /**
+     * \brief Handle the deadline of the next frame
+     */
+    void PlayFrame (void);
+
+    /**
+     * \brief Report the QoE counters and schedule the next summary
+     */
+    void Summary (void);
+
+    /**
+     * \brief Ask the server for another video level
+     * \param socket The client socket
+     * \param to The server address
+     * \param level The new level
+     */
+    void ChangeLevel (Ptr<Socket> socket, const Address& to, uint16_t level);
+
     //uint8_t m_priority;
+    uint32_t m_startupFrames;      ///< Frames buffered before playing
+    uint32_t m_playoutWindow;      ///< Frames tracked ahead of the playout point
+    Time m_summaryInterval;        ///< Period of the QoE summary, zero to disable
+    TypeId m_abrType;              ///< Strategy created when none is set
+    Time m_abrInterval;            ///< Minimum time between decisions
+    Time m_lastAbr;                ///< Time of the last decision
+    Ptr<UavAbrAlgorithm> m_abr;    ///< Quality adaptation strategy
+    UavVideoPlayout m_playout;     ///< Reassembly and playout state
+    uint32_t m_framesComplete;     ///< Frames with every fragment received
+    EventId m_playEvent;           ///< Next frame deadline
+    EventId m_summaryEvent;        ///< Next QoE summary
+
+    TracedCallback<Time> m_startupTrace;                      ///< Playback started
+    TracedCallback<uint32_t> m_framePlayedTrace;              ///< Frame played at its deadline
+    TracedCallback<uint32_t> m_frameLostTrace;                ///< Frame skipped at its deadline
+    TracedCallback<Time> m_stallTrace;                        ///< Stall ended
+    TracedCallback<uint16_t, uint16_t> m_qualityChangeTrace;  ///< Video level changed
+    TracedCallback<const UavVideoPlayout::Stats&> m_qoeSummaryTrace; ///< Periodic QoE summary
 };
 }
 
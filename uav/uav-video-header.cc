@@ -0,0 +1,57 @@
+#include "uav-video-header.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED(UavVideoHeader);
+
+TypeId UavVideoHeader::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::UavVideoHeader")
+        .SetParent<Header>()
+        .AddConstructor<UavVideoHeader>();
+    return tid;
+}
+
+TypeId UavVideoHeader::GetInstanceTypeId() const
+{
+    return GetTypeId();
+}
+
+UavVideoHeader::UavVideoHeader()
+    : m_frame(0),
+      m_fragment(0),
+      m_fragmentCount(1),
+      m_priority(2),
+      m_timestamp(0) {}
+
+uint32_t UavVideoHeader::GetSerializedSize() const
+{
+    return 4 + 2 + 2 + 1 + 8;
+}
+
+void UavVideoHeader::Serialize(Buffer::Iterator start) const
+{
+    start.WriteHtonU32(m_frame);
+    start.WriteHtonU16(m_fragment);
+    start.WriteHtonU16(m_fragmentCount);
+    start.WriteU8(m_priority);
+    start.WriteHtonU64(static_cast<uint64_t>(m_timestamp));
+}
+
+uint32_t UavVideoHeader::Deserialize(Buffer::Iterator start)
+{
+    m_frame = start.ReadNtohU32();
+    m_fragment = start.ReadNtohU16();
+    m_fragmentCount = start.ReadNtohU16();
+    m_priority = start.ReadU8();
+    m_timestamp = static_cast<int64_t>(start.ReadNtohU64());
+    return GetSerializedSize();
+}
+
+void UavVideoHeader::Print(std::ostream& os) const
+{
+    os << "frame=" << m_frame << " fragment=" << m_fragment << "/" << m_fragmentCount
+       << " priority=" << (int)m_priority << " ts=" << GetTimestamp().As(Time::MS);
+}
+
+} // namespace ns3
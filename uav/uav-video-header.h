@@ -0,0 +1,58 @@
+#ifndef UAV_VIDEO_HEADER_H
+#define UAV_VIDEO_HEADER_H
+
+#include "ns3/header.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup uav
+ * \brief Fixed-size header in front of every UavVideoServer packet
+ *
+ * Carries the frame number, the index of the fragment within the frame,
+ * the number of fragments of the frame, the priority class and the send
+ * time in 17 bytes, in network byte order. The rest of the packet is a
+ * zero-filled virtual payload, so the receiver reads the header with
+ * PeekHeader() and never copies the payload, and knows when a frame is
+ * complete without waiting for the next one.
+ */
+class UavVideoHeader : public Header
+{
+public:
+    static TypeId GetTypeId();
+    TypeId GetInstanceTypeId() const override;
+
+    UavVideoHeader();
+
+    void SetFrame(uint32_t frame) { m_frame = frame; }
+    uint32_t GetFrame() const { return m_frame; }
+
+    void SetFragment(uint16_t fragment) { m_fragment = fragment; }
+    uint16_t GetFragment() const { return m_fragment; }
+
+    void SetFragmentCount(uint16_t count) { m_fragmentCount = count; }
+    uint16_t GetFragmentCount() const { return m_fragmentCount; }
+
+    void SetPriority(uint8_t priority) { m_priority = priority; }
+    uint8_t GetPriority() const { return m_priority; }
+
+    void SetTimestamp(Time timestamp) { m_timestamp = timestamp.GetNanoSeconds(); }
+    Time GetTimestamp() const { return NanoSeconds(m_timestamp); }
+
+    uint32_t GetSerializedSize() const override;
+    void Serialize(Buffer::Iterator start) const override;
+    uint32_t Deserialize(Buffer::Iterator start) override;
+    void Print(std::ostream& os) const override;
+
+private:
+    uint32_t m_frame;    ///< Frame number
+    uint16_t m_fragment; ///< Fragment index within the frame
+    uint16_t m_fragmentCount; ///< Fragments of the frame
+    uint8_t m_priority;  ///< Priority class of the video packets
+    int64_t m_timestamp; ///< Send time in nanoseconds
+};
+
+} // namespace ns3
+
+#endif
@@ -0,0 +1,121 @@
+#include "uav-video-playout.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("UavVideoPlayout");
+
+UavVideoPlayout::UavVideoPlayout(uint32_t window, uint32_t startupFrames)
+    : m_slots(window > 0 ? window : 1),
+      m_startupFrames(startupFrames),
+      m_started(false),
+      m_playing(false),
+      m_stalled(false),
+      m_nextFrame(0),
+      m_highestFrame(0) {}
+
+bool UavVideoPlayout::AddFragment(Time now, uint32_t frame, uint16_t fragmentCount, uint32_t bytes) {
+    if(!m_started) {
+        m_started = true;
+        m_firstArrival = now;
+        m_nextFrame = frame;
+        m_highestFrame = frame;
+    }
+    if(frame < m_nextFrame) {
+        NS_LOG_LOGIC("Fragment of frame " << frame << " after its deadline");
+        return false;
+    }
+    if(frame - m_nextFrame >= m_slots.size()) {
+        NS_LOG_WARN("Frame " << frame << " is more than " << m_slots.size()
+                    << " frames ahead of playout, fragment dropped");
+        return false;
+    }
+    m_highestFrame = std::max(m_highestFrame, frame);
+
+    Slot& slot = SlotOf(frame);
+    if(slot.received == 0 || slot.frame != frame) {
+        slot = Slot{frame, 0, fragmentCount, 0, now, bytes};
+    }
+    slot.received++;
+    slot.bytes += bytes;
+    if(slot.received != slot.count) {
+        return false;
+    }
+    m_lastComplete = CompleteFrame{frame, slot.bytes, slot.firstBytes, now - slot.first};
+    return true;
+}
+
+bool UavVideoPlayout::IsComplete(uint32_t frame) const {
+    const Slot& slot = SlotOf(frame);
+    return slot.received > 0 && slot.frame == frame && slot.received >= slot.count;
+}
+
+uint32_t UavVideoPlayout::GetBufferedFrames() const {
+    uint32_t frames = 0;
+    while(frames < m_slots.size() && IsComplete(m_nextFrame + frames)) {
+        frames++;
+    }
+    return frames;
+}
+
+bool UavVideoPlayout::CanStart() const {
+    if(!m_started || m_playing) {
+        return false;
+    }
+    uint32_t frames = 0;
+    while(frames < m_startupFrames && frames < m_slots.size() &&
+          IsComplete(m_nextFrame + frames)) {
+        frames++;
+    }
+    return frames >= m_startupFrames || frames == m_slots.size();
+}
+
+void UavVideoPlayout::Start(Time now) {
+    NS_ASSERT(m_started && !m_playing);
+    m_playing = true;
+    m_stats.startupDelay = now - m_firstArrival;
+}
+
+UavVideoPlayout::TickResult UavVideoPlayout::Tick(Time now, uint32_t& frame) {
+    NS_ASSERT(m_playing && !m_stalled);
+    frame = m_nextFrame;
+    Slot& slot = SlotOf(frame);
+    if(IsComplete(frame)) {
+        m_stats.framesPlayed++;
+        m_stats.bytes += slot.bytes;
+        slot.received = 0;
+        m_nextFrame++;
+        return PLAYED;
+    }
+    if(m_highestFrame > frame) {
+        // Later frames are arriving, the missing fragments are gone
+        m_stats.framesLost++;
+        slot.received = 0;
+        m_nextFrame++;
+        return LOST;
+    }
+    m_stalled = true;
+    m_stallStart = now;
+    return STALLED;
+}
+
+bool UavVideoPlayout::CanResume() const {
+    return m_stalled && (IsComplete(m_nextFrame) || m_highestFrame > m_nextFrame);
+}
+
+Time UavVideoPlayout::Resume(Time now) {
+    NS_ASSERT(m_stalled);
+    m_stalled = false;
+    Time duration = now - m_stallStart;
+    m_stats.stalls++;
+    m_stats.stallTime += duration;
+    return duration;
+}
+
+void UavVideoPlayout::RecordSwitch() {
+    m_stats.switches++;
+}
+
+} // namespace ns3
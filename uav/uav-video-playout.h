@@ -0,0 +1,169 @@
+#ifndef UAV_VIDEO_PLAYOUT_H
+#define UAV_VIDEO_PLAYOUT_H
+
+#include "ns3/nstime.h"
+#include <cstdint>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup uav
+ * \brief Frame reassembly and playout model of a video client
+ *
+ * Fragments are counted per frame in a ring of "window" slots indexed by
+ * frame number, so tracking costs O(1) per fragment and memory does not
+ * grow with the stream. Playback starts once the first "startup" frames
+ * are complete; the startup delay is measured from the first fragment.
+ * After that one frame is due every frame period. At each deadline the
+ * due frame is played if complete, counted as lost if a later frame has
+ * already started arriving (its missing fragments will not come), and
+ * otherwise the player stalls until the frame completes or later data
+ * arrives.
+ *
+ * A stall still going on, as at the end of the stream, is not counted.
+ *
+ * The model has no timers of its own: the owner calls Tick() at every
+ * deadline while playing and Resume() once CanResume() turns true during
+ * a stall, passing the current time.
+ */
+class UavVideoPlayout
+{
+public:
+    /**
+     * \brief Quality of experience counters
+     */
+    struct Stats {
+        Time startupDelay;         ///< First fragment to first played frame
+        uint32_t framesPlayed = 0; ///< Frames complete at their deadline
+        uint32_t framesLost = 0;   ///< Frames skipped with missing fragments
+        uint32_t stalls = 0;       ///< Number of ended stalls
+        Time stallTime;            ///< Total duration of ended stalls
+        uint32_t switches = 0;     ///< Quality level changes
+        uint64_t bytes = 0;        ///< Bytes of played frames
+
+        /**
+         * \brief Fraction of due frames that were lost
+         */
+        double GetLossRatio() const {
+            uint32_t due = framesPlayed + framesLost;
+            return due > 0 ? static_cast<double>(framesLost) / due : 0.0;
+        }
+    };
+
+    /**
+     * \brief A frame whose fragments all arrived
+     */
+    struct CompleteFrame {
+        uint32_t frame = 0;
+        uint32_t bytes = 0;   ///< Bytes of all fragments
+        uint32_t firstBytes = 0; ///< Bytes of the fragment that started the spread
+        Time spread;          ///< First to last fragment arrival
+    };
+
+    /**
+     * \brief Outcome of a frame deadline
+     */
+    enum TickResult {
+        PLAYED,
+        LOST,
+        STALLED
+    };
+
+    /**
+     * \param window Number of frames tracked ahead of the playout point
+     * \param startupFrames Complete frames needed to start playing
+     */
+    explicit UavVideoPlayout(uint32_t window = 256, uint32_t startupFrames = 15);
+
+    /**
+     * \brief Count a received fragment
+     * \param now The current time
+     * \param frame The frame number
+     * \param fragmentCount Fragments the frame was sent in
+     * \param bytes Size of the fragment
+     * \return True if the fragment completed its frame
+     */
+    bool AddFragment(Time now, uint32_t frame, uint16_t fragmentCount, uint32_t bytes);
+
+    /**
+     * \brief Get the frame last completed by AddFragment()
+     */
+    const CompleteFrame& GetLastComplete() const { return m_lastComplete; }
+
+    /**
+     * \brief Whether enough frames are buffered to start playing
+     */
+    bool CanStart() const;
+
+    /**
+     * \brief Start playing
+     * \param now The current time
+     */
+    void Start(Time now);
+
+    /**
+     * \brief Handle the deadline of the next frame
+     * \param now The current time
+     * \param frame Set to the frame played or lost
+     * \return What happened to the frame
+     */
+    TickResult Tick(Time now, uint32_t& frame);
+
+    /**
+     * \brief Whether a stall can end
+     */
+    bool CanResume() const;
+
+    /**
+     * \brief End a stall
+     * \param now The current time
+     * \return The stall duration
+     */
+    Time Resume(Time now);
+
+    /**
+     * \brief Count a quality level change
+     */
+    void RecordSwitch();
+
+    bool IsPlaying() const { return m_playing; }
+    bool IsStalled() const { return m_stalled; }
+
+    /**
+     * \brief Get the complete frames waiting to be played
+     */
+    uint32_t GetBufferedFrames() const;
+
+    const Stats& GetStats() const { return m_stats; }
+
+private:
+    struct Slot {
+        uint32_t frame = 0;
+        uint16_t received = 0; ///< Fragments received, 0 for a free slot
+        uint16_t count = 0;    ///< Fragments the frame was sent in
+        uint32_t bytes = 0;
+        Time first;            ///< Arrival of the first fragment
+        uint32_t firstBytes = 0; ///< Size of the first fragment
+    };
+
+    Slot& SlotOf(uint32_t frame) { return m_slots[frame % m_slots.size()]; }
+    const Slot& SlotOf(uint32_t frame) const { return m_slots[frame % m_slots.size()]; }
+    bool IsComplete(uint32_t frame) const;
+
+    std::vector<Slot> m_slots;  ///< Frames from m_nextFrame on
+    uint32_t m_startupFrames;
+    bool m_started;             ///< Whether a fragment was received
+    bool m_playing;
+    bool m_stalled;
+    uint32_t m_nextFrame;       ///< Next frame due
+    uint32_t m_highestFrame;    ///< Highest frame a fragment was received of
+    Time m_firstArrival;
+    Time m_stallStart;
+    CompleteFrame m_lastComplete;
+    Stats m_stats;
+};
+
+} // namespace ns3
+
+#endif
@@ -1,4 +1,5 @@
 #include "uav-video-server.h"
+#include "uav-video-header.h"
 #include "ns3/log.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv6-address.h"
@@ -27,7 +28,8 @@ TypeId UavVideoServer::GetTypeId()
     return tid;
 }
 
-UavVideoServer::UavVideoServer() {}
+UavVideoServer::UavVideoServer()
+    : m_maxPacketSize(0) {}
 
 void UavVideoServer::SendPacket(ClientInfo* client, uint32_t packetSize)
 {
@@ -37,22 +39,82 @@ void UavVideoServer::SendPacket(ClientInfo* client, uint32_t packetSize)
         NS_LOG_ERROR("Invalid client or socket");
         return;
     }
-    
+
+    // The base class sends a frame as full-size slices followed by the
+    // remainder, all at the same instant. Slices are held until the
+    // remainder so that every header carries the fragment count. An entry
+    // only exists while slices are held, so none outlives its frame.
+    auto it = m_pending.find(client);
+    if (it != m_pending.end() && it->second.frame != client->m_sent) {
+        SendFrame(client, it->second);
+        m_pending.erase(it);
+    }
+    PendingFrame& pending = m_pending[client];
+    pending.frame = client->m_sent;
+    if (packetSize > 0) {
+        pending.sizes.push_back(packetSize);
+    }
+    if (packetSize < GetMaxPacketSize()) {
+        SendFrame(client, pending);
+        m_pending.erase(client);
+    }
+}
+
+void UavVideoServer::StopApplication()
+{
+    // Slices held for a frame are dropped with the stream
+    m_pending.clear();
+    VideoStreamServer::StopApplication();
+}
+
+void UavVideoServer::DoDispose()
+{
+    m_pending.clear();
+    VideoStreamServer::DoDispose();
+}
+
+void UavVideoServer::SendFrame(ClientInfo* client, PendingFrame& pending)
+{
+    if (pending.sizes.empty()) {
+        pending.sizes.push_back(0); // The frame is still announced
+    }
     uint8_t priority = CalculateVideoPriority(client->m_videoLevel);
-    
-    uint8_t dataBuffer[packetSize];
-    sprintf((char*)dataBuffer, "%u", client->m_sent);
-    Ptr<Packet> p = Create<Packet>(reinterpret_cast<const uint8_t*>(dataBuffer), packetSize);
-    
-    PriorityTag priorityTag(priority);
-    p->AddPacketTag(priorityTag);
-    
-    if (m_socket->SendTo(p, 0, client->m_address) < 0)
-    {
-        NS_LOG_WARN("Failed to send video packet with priority " << (int)priority);
+
+    UavVideoHeader header;
+    header.SetFrame(pending.frame);
+    header.SetFragmentCount(static_cast<uint16_t>(pending.sizes.size()));
+    header.SetPriority(priority);
+    header.SetTimestamp(Simulator::Now());
+    uint32_t headerSize = header.GetSerializedSize();
+
+    for (size_t i = 0; i < pending.sizes.size(); i++) {
+        header.SetFragment(static_cast<uint16_t>(i));
+        // Zero-filled virtual payload; the header counts towards the size,
+        // so only slices smaller than the header grow
+        uint32_t size = pending.sizes[i];
+        Ptr<Packet> p = Create<Packet>(size > headerSize ? size - headerSize : 0);
+        p->AddHeader(header);
+
+        PriorityTag priorityTag(priority);
+        p->AddPacketTag(priorityTag);
+
+        if (m_socket->SendTo(p, 0, client->m_address) < 0)
+        {
+            NS_LOG_WARN("Failed to send video packet with priority " << (int)priority);
+        }
     }
+    pending.sizes.clear();
 }
 
+uint32_t UavVideoServer::GetMaxPacketSize()
+{
+    if (m_maxPacketSize == 0) {
+        UintegerValue maxPacketSize;
+        GetAttribute("MaxPacketSize", maxPacketSize);
+        m_maxPacketSize = maxPacketSize.Get();
+    }
+    return m_maxPacketSize;
+}
 
 uint8_t UavVideoServer::CalculateVideoPriority(uint16_t videoLevel) const
 {
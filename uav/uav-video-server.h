@@ -3,12 +3,26 @@
 
 #include "ns3/video-stream-server.h"
 #include "../priority/priority-tag.h"
+#include <map>
+#include <vector>
 
 namespace ns3 {
 
 class Socket;
 class Packet;
 
+/**
+ * \ingroup uav
+ * \brief VideoStreamServer that marks video priority and sends binary headers
+ *
+ * Every packet carries a UavVideoHeader (frame, fragment index and
+ * count, priority, send time) in front of a zero-filled virtual payload,
+ * so no payload bytes are allocated or copied. The header counts towards
+ * the slice size chosen by VideoStreamServer, so packets keep that size,
+ * except that a slice smaller than the header grows to the header size.
+ * A frame with no bytes is still announced by one header-only packet, so
+ * the client sees every frame.
+ */
 class UavVideoServer : public VideoStreamServer
 {
 public:
@@ -17,9 +31,36 @@ public:
     
 protected:
     virtual void SendPacket(ClientInfo* client, uint32_t packetSize) override;
+    virtual void DoDispose() override;
     
 private:
+    /**
+     * \brief Drop the held slices, then stop the stream
+     */
+    virtual void StopApplication() override;
+
     uint8_t CalculateVideoPriority(uint16_t videoLevel) const;
+
+    /**
+     * \brief Slices of the frame being sent to a client
+     */
+    struct PendingFrame {
+        uint32_t frame = 0;
+        std::vector<uint32_t> sizes; ///< Packet size of each slice
+    };
+
+    /**
+     * \brief Send the held slices of a frame with their fragment count
+     */
+    void SendFrame(ClientInfo* client, PendingFrame& pending);
+
+    /**
+     * \brief The "MaxPacketSize" attribute, read once
+     */
+    uint32_t GetMaxPacketSize();
+
+    std::map<const ClientInfo*, PendingFrame> m_pending; ///< Per client holding slices
+    uint32_t m_maxPacketSize; ///< Cached slice size, 0 until read
 };
 
 } // namespace ns3
@@ -1,14 +1,18 @@
 #include "zmq_receiver_app.h"
+#include "position_wire_format.h"
 #include "ns3/core-module.h"
 #include "ns3/string.h"   
 #include "ns3/uinteger.h"  
 #include "ns3/network-module.h"
 #include "ns3/internet-module.h"
 #include "ns3/pointer.h"
+#include "ns3/boolean.h"
+#include "ns3/integer.h"
 #include "ns3/node-list.h"
 #include <time.h>
 #include <nlohmann/json.hpp>
 #include <iostream>
+#include <cstring>
 #include "uav/uav-telemetry.h"
 #include "uav/uav-command.h"
 #include "ns3/applications-module.h"
@@ -35,12 +39,45 @@ TypeId ZmqReceiverApp::GetTypeId()
                       StringValue("ns3"),
                       MakeStringAccessor(&ZmqReceiverApp::m_id),
                       MakeStringChecker())
+        .AddAttribute("QueueSize", "Commands the receiver thread may queue ahead of the simulator",
+                      UintegerValue(4096),
+                      MakeUintegerAccessor(&ZmqReceiverApp::m_queueSize),
+                      MakeUintegerChecker<uint32_t>(2))
+        .AddAttribute("RcvHwm", "ZMQ_RCVHWM, messages queued by ZMQ before newer ones are dropped",
+                      UintegerValue(1000),
+                      MakeUintegerAccessor(&ZmqReceiverApp::m_rcvHwm),
+                      MakeUintegerChecker<uint32_t>())
+        .AddAttribute("RcvBuf", "ZMQ_RCVBUF, kernel receive buffer in bytes, -1 for the OS default",
+                      IntegerValue(-1),
+                      MakeIntegerAccessor(&ZmqReceiverApp::m_rcvBuf),
+                      MakeIntegerChecker<int32_t>(-1))
+        .AddAttribute("Conflate", "ZMQ_CONFLATE, keep only the newest message. Only for position "
+                      "streams: application events may be dropped, and publishers must use "
+                      "single-frame \"topic body\" messages since ZMQ does not conflate multipart ones",
+                      BooleanValue(false),
+                      MakeBooleanAccessor(&ZmqReceiverApp::m_conflate),
+                      MakeBooleanChecker())
+        .AddAttribute("BinaryTopic", "Topic of binary position messages, empty for the ID followed by \".bin\"",
+                      StringValue(""),
+                      MakeStringAccessor(&ZmqReceiverApp::m_binaryTopic),
+                      MakeStringChecker())
+        .AddAttribute("MobilityTick", "Period at which the latest received positions are applied",
+                      TimeValue(MilliSeconds(20)),
+                      MakeTimeAccessor(&ZmqReceiverApp::m_mobilityTick),
+                      MakeTimeChecker(MicroSeconds(1)))
         .AddConstructor<ZmqReceiverApp>();
     return tid;
 }
 
 ZmqReceiverApp::ZmqReceiverApp()
     : m_running(false),
+      m_queueSize(4096),
+      m_drainScheduled(false),
+      m_nodeId(0),
+      m_mobilityTick(MilliSeconds(20)),
+      m_rcvHwm(1000),
+      m_rcvBuf(-1),
+      m_conflate(false),
       m_thread(nullptr),
       m_address("localhost"),
       m_port(5555),
@@ -54,8 +91,25 @@ ZmqReceiverApp::ZmqReceiverApp()
 
 void ZmqReceiverApp::StartApplication()
 {
+    m_commands = std::make_unique<SpscQueue<ZmqCommand>>(m_queueSize);
+    m_drainScheduled = false;
+    m_nodeId = GetNode()->GetId();
+    m_positions = std::make_unique<PositionTable>(NodeList::GetNNodes());
+    m_mobilityEvent = Simulator::Schedule(m_mobilityTick, &ZmqReceiverApp::ApplyPositions, this);
     m_running = true;
+    if (m_binaryTopic.empty())
+    {
+        m_binaryTopic = m_id + ".bin";
+    }
+    m_lastTimestamp.assign(NodeList::GetNNodes(), 0);
+    m_socket.set(zmq::sockopt::rcvhwm, static_cast<int>(m_rcvHwm));
+    m_socket.set(zmq::sockopt::rcvbuf, static_cast<int>(m_rcvBuf));
+    if (m_conflate)
+    {
+        m_socket.set(zmq::sockopt::conflate, true);
+    }
     m_socket.set(zmq::sockopt::subscribe, m_id);
+    m_socket.set(zmq::sockopt::subscribe, m_binaryTopic);
     //m_socket.set(zmq::sockopt::subscribe, m_heartBeatTopic);
     m_socket.connect("tcp://" + m_address + ":" + std::to_string(m_port));
     m_thread = std::make_unique<std::thread>(&ZmqReceiverApp::Run, this);
@@ -64,6 +118,7 @@ void ZmqReceiverApp::StartApplication()
 void ZmqReceiverApp::StopApplication()
 {
     m_running = false;
+    Simulator::Cancel(m_mobilityEvent);
     if (m_thread && m_thread->joinable())
     {
         m_thread->join();
@@ -74,182 +129,326 @@ void ZmqReceiverApp::Run()
 {
     while (m_running)
     {
-        zmq::recv_result_t result = m_socket.recv(m_message, zmq::recv_flags::none);
+        zmq::recv_result_t result = m_socket.recv(m_topic, zmq::recv_flags::none);
         if (!result)
         {
             NS_LOG_ERROR("Failed to receive message: " << zmq_strerror(zmq_errno()));
             break;
         }
 
-        std::string message = std::string(static_cast<char*>(m_message.data()), m_message.size());
+        // Payloads are parsed in place, without copies
+        const char* body;
+        size_t size;
+        bool binary;
+        if (m_topic.more())
+        {
+            // Multipart: topic frame, then payload frame
+            result = m_socket.recv(m_message, zmq::recv_flags::none);
+            if (!result)
+            {
+                NS_LOG_ERROR("Failed to receive message: " << zmq_strerror(zmq_errno()));
+                break;
+            }
+            bool more = m_message.more();
+            zmq::message_t extra;
+            while (more && m_socket.recv(extra, zmq::recv_flags::none))
+            {
+                NS_LOG_WARN("Ignored extra frame of " << extra.size() << " bytes");
+                more = extra.more();
+            }
+            if (m_topic.size() == m_binaryTopic.size() &&
+                std::memcmp(m_topic.data(), m_binaryTopic.data(), m_binaryTopic.size()) == 0)
+            {
+                binary = true;
+            }
+            else if (m_topic.size() == m_id.size() &&
+                     std::memcmp(m_topic.data(), m_id.data(), m_id.size()) == 0)
+            {
+                binary = false;
+            }
+            else
+            {
+                NS_LOG_LOGIC("Ignored message of another topic");
+                continue;
+            }
+            body = static_cast<const char*>(m_message.data());
+            size = m_message.size();
+        }
+        else
+        {
+            // Single frame "topic body", as sent by older publishers and with Conflate
+            const char* data = static_cast<const char*>(m_topic.data());
+            size_t binaryOffset = m_binaryTopic.size() + 1;
+            size_t offset = m_id.size() + 1;
+            if (m_topic.size() >= binaryOffset && data[m_binaryTopic.size()] == ' ' &&
+                std::memcmp(data, m_binaryTopic.data(), m_binaryTopic.size()) == 0)
+            {
+                binary = true;
+                offset = binaryOffset;
+            }
+            else if (m_topic.size() >= offset)
+            {
+                binary = false;
+            }
+            else
+            {
+                NS_LOG_WARN("Message shorter than its topic");
+                continue;
+            }
+            body = data + offset;
+            size = m_topic.size() - offset;
+        }
+
+        if (binary)
+        {
+            std::string error;
+            if (PositionWireFormat::Decode(reinterpret_cast<const uint8_t*>(body), size, m_binaryActors, error))
+            {
+                StorePositions(m_binaryActors);
+            }
+            else
+            {
+                NS_LOG_ERROR("Binary Position Error: " << error);
+            }
+            continue;
+        }
 
-        // Parse JSON message
-        try
+        switch (m_parser.Parse(body, size))
         {
-            json jsonData = json::parse(message.substr(m_id.size() + 1));
-    
-            if (jsonData.contains("actors"))
+        case ActorMessageParser::ACTORS:
+            StorePositions(m_parser.GetActors());
+            if (m_parser.GetSkipped() > 0)
+            {
+                NS_LOG_WARN("Skipped " << m_parser.GetSkipped() << " actors with an unknown id or missing coordinates");
+            }
+            break;
+        case ActorMessageParser::OTHER:
+            // Application events are rare, a DOM is fine for them
+            try
             {
-                for (auto& actor : jsonData["actors"])
+                json jsonData = json::parse(body, body + size);
+                if (jsonData.contains("event_type"))
                 {
-                    std::string id = actor["id"];
-                    double x = actor["x"];
-                    double y = actor["y"];
-                    double z = actor["z"];
-
-                    NS_LOG_INFO("Received Position for " << id << ": (" << x << ", " << y << ", " << z << ")");
-
-                    Vector position(x, y, z);
-                    uint32_t nodeId;
-
-                    // Handle different actor types
-                    if (id.find("uav") == 0) {
-                        // Extract UAV number from ID (e.g., "uav1" -> 1)
-                        try {
-                            nodeId = static_cast<uint32_t>(std::stoi(id.substr(3)));
-                        } catch (const std::exception& e) {
-                            NS_LOG_WARN("Invalid UAV ID format: " << id);
-                            continue;
-                        }
-                    } else if (id == "gcs") {
-                        // Assign ground control station to node 0
-                        nodeId = 0;
-                    } else {
-                        NS_LOG_WARN("Unknown actor type: " << id);
-                        continue;
-                    }
-
-                    // Find and update the node position
-                    Ptr<Node> node = NodeList::GetNode(nodeId);
-                    if (node) {
-                        SetNodePosition(node, position);
-                    } else {
-                        NS_LOG_WARN("Node not found for ID: " << nodeId);
+                    std::string event = jsonData["event_type"];
+                    ZmqCommand command;
+                    command.appType = jsonData["app_type"];
+                    // AppType type = getAppTypeFromString(app_type);
+
+                    if (event == "start") {
+                        command.type = ZmqCommand::START_APP;
+                        command.config = jsonData["config"];
+                        command.localId = jsonData["local_id"];
+                        Push(command);
+                    } else if (event == "stop") {
+                        command.type = ZmqCommand::STOP_APP;
+                        Push(command);
                     }
                 }
-            } else if (jsonData.contains("event_type"))
+            }
+            catch (json::exception& e)
             {
-                std::string command = jsonData["event_type"];
-                std::string app_type = jsonData["app_type"];
-                // AppType type = getAppTypeFromString(app_type);
-
-                Ptr<Node> gcsNode = NodeList::GetNode(0);
-                Ptr<Node> uavNode = NodeList::GetNode(1);
-                uint32_t numApplication;
-
-                if (command == "start") {
-                    // Handle application start
-                    std::string config = jsonData["config"];
-                    int local_id = jsonData["local_id"];
-                    Ipv4InterfaceAddress gcsInterfAddress = gcsNode->GetObject<Ipv4>()->GetAddress(1, 0);
-                    Ipv4Address gcsAddress = gcsInterfAddress.GetAddress();
-
-                    Ipv4InterfaceAddress uavInterfAddress = uavNode->GetObject<Ipv4>()->GetAddress(1, 0);
-                    Ipv4Address uavAddress = uavInterfAddress.GetAddress();
-
-                    if (app_type == "Telemetry") {
-                        TypeId tid = TypeId::LookupByName("ns3::UdpSocketFactory");
-                        Ptr<Socket> criticalSocket = Socket::CreateSocket(uavNode, tid);
-                        InetSocketAddress local = InetSocketAddress(Ipv4Address::GetAny(), 9);
-                        criticalSocket->Bind(local);
-                        
-                        InetSocketAddress remote = InetSocketAddress(gcsAddress, 9);
-                        criticalSocket->Connect(remote);
-
-                        Ptr<UavTelemetry> telemetryApp = CreateObject<UavTelemetry>();
-                        telemetryApp->SetInterval(Seconds(0.1));
-                        telemetryApp->SetPacketSize(150);
-                        telemetryApp->SetSocket(criticalSocket);
-
-                        numApplication = uavNode->GetNApplications();
-                        m_telemetryAppList.insert({1, numApplication});
-                        uavNode->AddApplication(telemetryApp);
-
-                        telemetryApp->SetStartTime(Seconds(0.0));
-                        telemetryApp->SetStopTime(Time::Max());
-
-                        NS_LOG_INFO("Started Telemetry app for uav1, app index" << numApplication);
-                    } else if (app_type == "VideoStream") {
-                        VideoStreamServerHelper videoServer (5000);
-                        videoServer.SetAttribute ("MaxPacketSize", UintegerValue (1400));
-                        numApplication = uavNode->GetNApplications();
-                        m_videoServerAppList.insert({1, numApplication});
-                        ApplicationContainer serverApp = videoServer.Install (uavNode);
-                        serverApp.Start (Seconds (0.0));
-                        serverApp.Stop (Time::Max());
-
-                        NS_LOG_INFO("Started Video server app for uav1, app index" << numApplication);
-
-                        VideoStreamClientHelper videoClient(uavAddress, 5000);
-                        numApplication = gcsNode->GetNApplications();
-                        m_gcsVideoClientAppList.insert({1, numApplication});
-                        ApplicationContainer clientApp = videoClient.Install(gcsNode);
-                        clientApp.Start (Seconds(0.0));
-                        clientApp.Stop (Time::Max());
-
-                        NS_LOG_INFO("Started Video client app for gcs, app index" << numApplication);
-                    } else if (app_type == "ControlCommands") {
-                        for (uint32_t i = 0; i <= gcsNode->GetNApplications() - 1; i++) {
-                            Ptr<Application> app = gcsNode->GetApplication(i);
-                            Ptr<UavCommand> commandApp = DynamicCast<UavCommand>(app);
-                            if (commandApp) {
-                                commandApp->SendCommand(PRIO_CRITICAL);
-                                NS_LOG_INFO("Sent command with prio " << PRIO_CRITICAL);
-                            }
-                        }
-                    }
-                    NS_LOG_INFO("Received start event for " << app_type << " with config: " << config << " (Local ID: " << local_id << ")");
-                } else if (command == "stop") {
-                    NS_LOG_INFO("Received stop event for " << app_type);
-
-                    if (app_type == "Telemetry") {
-                        uint32_t appIndex;
-                        for (const auto &entry : m_telemetryAppList) {{
-                            if (entry.first == 1) {
-                                appIndex = entry.second;
-                                Ptr<Application> app = uavNode->GetApplication(appIndex);
-                                Ptr<UavTelemetry> telemetryApp = DynamicCast<UavTelemetry>(app);
-                                if (telemetryApp) {
-                                    telemetryApp->StopApplication();
-                                }
-
-                                NS_LOG_INFO("Stop telemetry app for uav 1 at app index " << appIndex);
-                            }
-                        }}
-                    } else if (app_type == "VideoStream") {
-                        uint32_t appIndex;
-                        for (const auto &entry : m_videoServerAppList) {{
-                            if (entry.first == 1) {
-                                appIndex = entry.second;
-                                Ptr<Application> app = uavNode->GetApplication(appIndex);
-                                Ptr<VideoStreamServer> videoServerApp = DynamicCast<VideoStreamServer>(app);
-                                if (videoServerApp) {
-                                    videoServerApp->StopApplication();
-                                }
-
-                                NS_LOG_INFO("Stop video server app for uav 1 at app index " << appIndex);
-                            }
-                        }}
-                        for (const auto &entry : m_gcsVideoClientAppList) {{
-                            if (entry.first == 1) {
-                                appIndex = entry.second;
-                                Ptr<Application> app = gcsNode->GetApplication(appIndex);
-                                Ptr<VideoStreamClient> videoClientApp = DynamicCast<VideoStreamClient>(app);
-                                if (videoClientApp) {
-                                    videoClientApp->StopApplication();
-                                }
-
-                                NS_LOG_INFO("Stop video client app for gcs of uav 1 at app index " << appIndex);
-                            }
-                        }}
-                    }
-                }
+                NS_LOG_ERROR("JSON Parsing Error: " << e.what());
             }
+            break;
+        case ActorMessageParser::ERROR:
+            NS_LOG_ERROR("JSON Parsing Error: " << m_parser.GetError());
+            break;
         }
-        catch (json::parse_error& e)
+    }
+}
+
+void ZmqReceiverApp::StorePositions(const std::vector<ActorSample>& actors)
+{
+    for (const ActorSample& actor : actors)
+    {
+        if (actor.nodeId < m_lastTimestamp.size() && actor.timestamp > 0)
+        {
+            if (actor.timestamp < m_lastTimestamp[actor.nodeId])
+            {
+                NS_LOG_LOGIC("Dropped position of node " << actor.nodeId << " older than the last one");
+                continue;
+            }
+            m_lastTimestamp[actor.nodeId] = actor.timestamp;
+        }
+        // Replaces any position of the node not applied yet
+        if (!m_positions->Store(actor.nodeId, actor.position)) {
+            NS_LOG_WARN("Node not found for ID: " << actor.nodeId);
+        }
+    }
+}
+
+void ZmqReceiverApp::Push(ZmqCommand& command)
+{
+    // Commands are never dropped, wait for the simulator to catch up
+    while (!m_commands->TryPush(command))
+    {
+        if (!m_running)
         {
-            NS_LOG_ERROR("JSON Parsing Error: " << e.what());
+            return;
         }
+        std::this_thread::yield();
+    }
+    // One pending drain serves every command queued before it runs
+    if (!m_drainScheduled.exchange(true, std::memory_order_acq_rel))
+    {
+        Simulator::ScheduleWithContext(m_nodeId, Seconds(0), &ZmqReceiverApp::Drain, this);
+    }
+}
+
+void ZmqReceiverApp::Drain()
+{
+    // Cleared first so that a command pushed during the drain schedules another
+    m_drainScheduled.store(false, std::memory_order_release);
+    ZmqCommand command;
+    uint32_t applied = 0;
+    while (m_commands->TryPop(command))
+    {
+        Apply(command);
+        applied++;
+    }
+    NS_LOG_LOGIC("Applied " << applied << " queued commands");
+}
+
+void ZmqReceiverApp::ApplyPositions()
+{
+    uint32_t updated = m_positions->Apply([this](uint32_t nodeId, const Vector& position) {
+        NS_LOG_INFO("Received Position for node " << nodeId << ": " << position);
+        SetNodePosition(NodeList::GetNode(nodeId), position);
+    });
+    if (updated > 0)
+    {
+        NS_LOG_LOGIC("Moved " << updated << " nodes, " << m_positions->GetStored() - m_positions->GetApplied()
+                     << " positions superseded so far");
+    }
+    m_mobilityEvent = Simulator::Schedule(m_mobilityTick, &ZmqReceiverApp::ApplyPositions, this);
+}
+
+void ZmqReceiverApp::Apply(const ZmqCommand& command)
+{
+    switch (command.type)
+    {
+    case ZmqCommand::START_APP:
+        StartApp(command);
+        break;
+    case ZmqCommand::STOP_APP:
+        StopApp(command);
+        break;
+    }
+}
+
+void ZmqReceiverApp::StartApp(const ZmqCommand& command)
+{
+    Ptr<Node> gcsNode = NodeList::GetNode(0);
+    Ptr<Node> uavNode = NodeList::GetNode(1);
+    uint32_t numApplication;
+
+    // Handle application start
+    Ipv4InterfaceAddress gcsInterfAddress = gcsNode->GetObject<Ipv4>()->GetAddress(1, 0);
+    Ipv4Address gcsAddress = gcsInterfAddress.GetAddress();
+
+    Ipv4InterfaceAddress uavInterfAddress = uavNode->GetObject<Ipv4>()->GetAddress(1, 0);
+    Ipv4Address uavAddress = uavInterfAddress.GetAddress();
+
+    if (command.appType == "Telemetry") {
+        TypeId tid = TypeId::LookupByName("ns3::UdpSocketFactory");
+        Ptr<Socket> criticalSocket = Socket::CreateSocket(uavNode, tid);
+        InetSocketAddress local = InetSocketAddress(Ipv4Address::GetAny(), 9);
+        criticalSocket->Bind(local);
+        
+        InetSocketAddress remote = InetSocketAddress(gcsAddress, 9);
+        criticalSocket->Connect(remote);
+
+        Ptr<UavTelemetry> telemetryApp = CreateObject<UavTelemetry>();
+        telemetryApp->SetInterval(Seconds(0.1));
+        telemetryApp->SetPacketSize(150);
+        telemetryApp->SetSocket(criticalSocket);
+
+        numApplication = uavNode->GetNApplications();
+        m_telemetryAppList.insert({1, numApplication});
+        uavNode->AddApplication(telemetryApp);
+
+        telemetryApp->SetStartTime(Seconds(0.0));
+        telemetryApp->SetStopTime(Time::Max());
+
+        NS_LOG_INFO("Started Telemetry app for uav1, app index" << numApplication);
+    } else if (command.appType == "VideoStream") {
+        VideoStreamServerHelper videoServer (5000);
+        videoServer.SetAttribute ("MaxPacketSize", UintegerValue (1400));
+        numApplication = uavNode->GetNApplications();
+        m_videoServerAppList.insert({1, numApplication});
+        ApplicationContainer serverApp = videoServer.Install (uavNode);
+        serverApp.Start (Seconds (0.0));
+        serverApp.Stop (Time::Max());
+
+        NS_LOG_INFO("Started Video server app for uav1, app index" << numApplication);
+
+        VideoStreamClientHelper videoClient(uavAddress, 5000);
+        numApplication = gcsNode->GetNApplications();
+        m_gcsVideoClientAppList.insert({1, numApplication});
+        ApplicationContainer clientApp = videoClient.Install(gcsNode);
+        clientApp.Start (Seconds(0.0));
+        clientApp.Stop (Time::Max());
+
+        NS_LOG_INFO("Started Video client app for gcs, app index" << numApplication);
+    } else if (command.appType == "ControlCommands") {
+        for (uint32_t i = 0; i <= gcsNode->GetNApplications() - 1; i++) {
+            Ptr<Application> app = gcsNode->GetApplication(i);
+            Ptr<UavCommand> commandApp = DynamicCast<UavCommand>(app);
+            if (commandApp) {
+                commandApp->SendCommand(PRIO_CRITICAL);
+                NS_LOG_INFO("Sent command with prio " << PRIO_CRITICAL);
+            }
+        }
+    }
+    NS_LOG_INFO("Received start event for " << command.appType << " with config: " << command.config << " (Local ID: " << command.localId << ")");
+}
+
+void ZmqReceiverApp::StopApp(const ZmqCommand& command)
+{
+    Ptr<Node> gcsNode = NodeList::GetNode(0);
+    Ptr<Node> uavNode = NodeList::GetNode(1);
+    NS_LOG_INFO("Received stop event for " << command.appType);
+
+    if (command.appType == "Telemetry") {
+        uint32_t appIndex;
+        for (const auto &entry : m_telemetryAppList) {{
+            if (entry.first == 1) {
+                appIndex = entry.second;
+                Ptr<Application> app = uavNode->GetApplication(appIndex);
+                Ptr<UavTelemetry> telemetryApp = DynamicCast<UavTelemetry>(app);
+                if (telemetryApp) {
+                    telemetryApp->StopApplication();
+                }
+
+                NS_LOG_INFO("Stop telemetry app for uav 1 at app index " << appIndex);
+            }
+        }}
+    } else if (command.appType == "VideoStream") {
+        uint32_t appIndex;
+        for (const auto &entry : m_videoServerAppList) {{
+            if (entry.first == 1) {
+                appIndex = entry.second;
+                Ptr<Application> app = uavNode->GetApplication(appIndex);
+                Ptr<VideoStreamServer> videoServerApp = DynamicCast<VideoStreamServer>(app);
+                if (videoServerApp) {
+                    videoServerApp->StopApplication();
+                }
+
+                NS_LOG_INFO("Stop video server app for uav 1 at app index " << appIndex);
+            }
+        }}
+        for (const auto &entry : m_gcsVideoClientAppList) {{
+            if (entry.first == 1) {
+                appIndex = entry.second;
+                Ptr<Application> app = gcsNode->GetApplication(appIndex);
+                Ptr<VideoStreamClient> videoClientApp = DynamicCast<VideoStreamClient>(app);
+                if (videoClientApp) {
+                    videoClientApp->StopApplication();
+                }
+
+                NS_LOG_INFO("Stop video client app for gcs of uav 1 at app index " << appIndex);
+            }
+        }}
     }
 }
 
@@ -3,7 +3,13 @@
 #include "ns3/node.h"
 #include "ns3/vector.h"
 #include "ns3/mobility-model.h"
+#include "actor_message_parser.h"
+#include "position_table.h"
+#include "spsc_queue.h"
 #include <zmq.hpp>
+#include <atomic>
+#include <memory>
+#include <set>
 #include <string>
 #include <iostream>
 #include <sstream>
@@ -18,6 +24,52 @@ using namespace ns3;
 //     SensorData
 // }
 
+/**
+ * \brief Application event received from the publisher, applied in the simulator thread
+ */
+struct ZmqCommand
+{
+    enum Type
+    {
+        START_APP, ///< Start an application
+        STOP_APP   ///< Stop an application
+    };
+
+    Type type = START_APP;
+    std::string appType;   ///< Application to start or stop
+    std::string config;    ///< Configuration of a started application
+    int localId = 0;       ///< Publisher's id of a started application
+};
+
+/**
+ * \brief Application driven by a ZMQ publisher
+ *
+ * A receiver thread only reads and parses messages, actor positions
+ * with the streaming ActorMessageParser. Application events become
+ * ZmqCommand items pushed into a lock-free SpscQueue; the thread then
+ * schedules one drain event with Simulator::ScheduleWithContext, which
+ * is safe to call from other threads. The drain runs in the simulator
+ * thread and applies every queued command in arrival order, so nodes,
+ * mobility models and applications are only touched by the simulator.
+ *
+ * Positions bypass the command queue: the thread stores them in a
+ * last-writer-wins PositionTable and a "MobilityTick" event moves each
+ * updated node once to its latest position. Intermediate samples of a
+ * fast feed are dropped instead of each firing CourseChange.
+ *
+ * Positions may also be published in the PositionWireFormat binary
+ * encoding under "BinaryTopic" (the ID followed by ".bin" by default).
+ * The topic selects the decoder per message, so JSON remains available
+ * for publishers that do not send binary. Binary records carry a
+ * timestamp; a record older than the last one stored for its node is
+ * dropped.
+ *
+ * Publishers send a topic frame followed by a payload frame. Single
+ * frame "topic body" messages are still accepted, which Conflate needs.
+ * RcvHwm, RcvBuf and Conflate set the matching ZMQ socket options, so a
+ * position stream can be limited to its freshest message instead of
+ * building a backlog.
+ */
 class ZmqReceiverApp : public Application
 {
 public:
@@ -32,7 +84,46 @@ public:
     void SetNodePosition(Ptr<Node> node, Vector position);
 
 private:
-    bool m_running;
+    /**
+     * \brief Queue a command for the simulator, from the receiver thread
+     */
+    void Push(ZmqCommand& command);
+
+    /**
+     * \brief Apply the queued commands, in the simulator thread
+     */
+    void Drain();
+
+    /**
+     * \brief Move the nodes whose position changed, every mobility tick
+     */
+    void ApplyPositions();
+
+    /**
+     * \brief Store decoded positions, from the receiver thread
+     */
+    void StorePositions(const std::vector<ActorSample>& actors);
+
+    void Apply(const ZmqCommand& command);
+    void StartApp(const ZmqCommand& command);
+    void StopApp(const ZmqCommand& command);
+
+    std::atomic<bool> m_running;
+    uint32_t m_queueSize;
+    std::unique_ptr<SpscQueue<ZmqCommand>> m_commands; ///< Receiver thread to simulator
+    std::atomic<bool> m_drainScheduled;                ///< Whether a Drain() event is pending
+    uint32_t m_nodeId;                                 ///< Context of the drain events
+    Time m_mobilityTick;                               ///< Period of ApplyPositions()
+    std::unique_ptr<PositionTable> m_positions;        ///< Latest position per node
+    ActorMessageParser m_parser;                       ///< Used by the receiver thread only
+    uint32_t m_rcvHwm;                                 ///< ZMQ_RCVHWM
+    int32_t m_rcvBuf;                                  ///< ZMQ_RCVBUF
+    bool m_conflate;                                   ///< ZMQ_CONFLATE
+    zmq::message_t m_topic;                            ///< Topic frame, or a whole single-frame message
+    std::string m_binaryTopic;                         ///< Topic of PositionWireFormat messages
+    std::vector<ActorSample> m_binaryActors;           ///< Decoded binary records, receiver thread
+    std::vector<double> m_lastTimestamp;               ///< Per node, receiver thread
+    EventId m_mobilityEvent;
     std::unique_ptr<std::thread> m_thread;
     std::string m_address;
     int m_port;